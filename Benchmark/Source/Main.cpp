@@ -0,0 +1,634 @@
+/*
+    Headless benchmark for the DISTROAR processing chain.
+
+    Runs DistroarEngine, as linked from the DistroarCore library, over a matrix of sample rates,
+    block sizes, channel counts, parameter settings and processing precisions,
+    then prints the results as JSON. It also times the waveshaper kernels and the FastMath
+    approximations (against libm) on their own, measures the aliasing left by each
+    anti-aliasing option next to its cost, and times the cabinet convolution's audio
+    thread share over a range of response lengths.
+
+    Usage: DistroarBenchmark [--quick] [--seconds=<audio seconds per case>] [--output=<file.json>]
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include <numeric>
+#include "../../Source/DistroarEngine.h"
+#include "../../Source/MultibandShaper.h"
+#include "../../Source/AdaaShaper.h"
+#include "../../Source/PartitionedConvolution.h"
+#include "../../Source/SimdFloat.h"
+#include "../../Source/FastMath.h"
+
+namespace
+{
+    //==============================================================================
+    struct ParameterSetting
+    {
+        const char* name;
+        float drive, blend, tone;
+        int shaperMode, oversampling, antiAliasing, crossover, numBands;
+        bool automateDrive; // Sweep drive between blocks to keep the smoothing ramps busy
+        bool silentInput;   // Feed digital silence, as on a track between takes
+        bool bypassed;
+    };
+
+    const ParameterSetting parameterSettings[] =
+    {
+        { "default",        0.5f, 0.5f, 10300.0f, 0, 0, 0, 0, 3, false, false, false },
+        { "lookupTable",    0.5f, 0.5f, 10300.0f, 1, 0, 0, 0, 3, false, false, false },
+        { "oversampling4x", 0.5f, 0.5f, 10300.0f, 0, 2, 0, 0, 3, false, false, false },
+        { "adaa2ndOrder",   0.5f, 0.5f, 10300.0f, 0, 0, 2, 0, 3, false, false, false },
+        { "automatedDrive", 0.5f, 0.5f, 10300.0f, 0, 0, 0, 0, 3, true,  false, false },
+        { "silence",        0.5f, 0.5f, 10300.0f, 0, 0, 0, 0, 3, false, true,  false },
+        { "bypassed",       0.5f, 0.5f, 10300.0f, 0, 2, 0, 0, 3, false, false, true },
+        { "fftCrossover",   0.5f, 0.5f, 10300.0f, 0, 0, 0, 1, 3, false, false, false },
+        { "sixBands",       0.5f, 0.5f, 10300.0f, 0, 0, 0, 0, 6, false, false, false }
+    };
+
+    // Anti-aliasing options compared by measureAliasing(), at a drive that makes aliasing obvious
+    const ParameterSetting aliasingSettings[] =
+    {
+        { "off",            0.8f, 0.5f, 10300.0f, 0, 0, 0, 0, 3, false, false, false },
+        { "adaa1stOrder",   0.8f, 0.5f, 10300.0f, 0, 0, 1, 0, 3, false, false, false },
+        { "adaa2ndOrder",   0.8f, 0.5f, 10300.0f, 0, 0, 2, 0, 3, false, false, false },
+        { "oversampling2x", 0.8f, 0.5f, 10300.0f, 0, 1, 0, 0, 3, false, false, false },
+        { "oversampling4x", 0.8f, 0.5f, 10300.0f, 0, 2, 0, 0, 3, false, false, false },
+        { "oversampling8x", 0.8f, 0.5f, 10300.0f, 0, 3, 0, 0, 3, false, false, false }
+    };
+
+    /** The engine parameters the plugin would pass for a setting, everything else at its default. */
+    DistroarEngine::Parameters getParameters(const ParameterSetting& setting)
+    {
+        DistroarEngine::Parameters parameters;
+        parameters.drive = setting.drive;
+        parameters.blend = setting.blend;
+        parameters.tone = setting.tone;
+        parameters.useLookupTables = setting.shaperMode == 1;
+        parameters.oversamplingStages = setting.oversampling;
+        parameters.antiAliasing = setting.antiAliasing;
+        parameters.linearPhaseCrossover = setting.crossover == 1;
+        parameters.numBands = setting.numBands;
+        parameters.bypassed = setting.bypassed;
+        return parameters;
+    }
+
+    //==============================================================================
+    /** One second of plucked low E with a bit of pickup noise, retriggered every half second. */
+    juce::AudioBuffer<float> makeTestSignal(int numChannels, double sampleRate)
+    {
+        juce::AudioBuffer<float> signal(numChannels, (int)sampleRate);
+        juce::Random random(1234);
+
+        const double frequency = 82.41;
+        const int retriggerInterval = (int)(sampleRate * 0.5);
+
+        for (int sample = 0; sample < signal.getNumSamples(); ++sample)
+        {
+            const double t = (double)(sample % retriggerInterval) / sampleRate;
+            const double envelope = std::exp(-4.0 * t);
+            double value = 0.0;
+
+            for (int harmonic = 1; harmonic <= 8; ++harmonic)
+                value += std::sin(juce::MathConstants<double>::twoPi * frequency * harmonic * t) / harmonic;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                signal.setSample(channel, sample, (float)(0.3 * envelope * value) + (random.nextFloat() - 0.5f) * 0.002f);
+        }
+
+        return signal;
+    }
+
+    double percentile(const std::vector<double>& sortedValues, double fraction)
+    {
+        const auto index = (size_t)juce::roundToInt(fraction * (double)(sortedValues.size() - 1));
+        return sortedValues[juce::jmin(index, sortedValues.size() - 1)];
+    }
+
+    //==============================================================================
+    template <typename SampleType>
+    juce::var runCase(double sampleRate, int blockSize, int numChannels, const ParameterSetting& setting, double secondsPerCase)
+    {
+        constexpr bool isDouble = std::is_same_v<SampleType, double>;
+        auto parameters = getParameters(setting);
+        DistroarEngine engine;
+        engine.setParameters(parameters);
+        engine.prepare(sampleRate, blockSize, numChannels, isDouble ? DistroarEngine::Precision::double_ : DistroarEngine::Precision::single);
+
+        const auto signal = makeTestSignal(numChannels, sampleRate);
+        juce::AudioBuffer<SampleType> block(numChannels, blockSize);
+
+        const int numBlocks = juce::jmax(32, (int)(secondsPerCase * sampleRate / blockSize));
+        const int numWarmupBlocks = numBlocks / 10;
+        std::vector<double> blockSeconds;
+        blockSeconds.reserve((size_t)numBlocks);
+
+        int readPosition = 0;
+        SampleType outputPeak = 0;
+
+        for (int blockIndex = -numWarmupBlocks; blockIndex < numBlocks; ++blockIndex)
+        {
+            for (int sample = 0; sample < blockSize; ++sample)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                    block.setSample(channel, sample, setting.silentInput ? SampleType(0) : (SampleType)signal.getSample(channel, readPosition));
+
+                readPosition = (readPosition + 1) % signal.getNumSamples();
+            }
+
+            if (setting.automateDrive)
+            {
+                // Triangle sweep over two seconds
+                const double phase = std::fmod((double)readPosition / sampleRate, 2.0);
+                parameters.drive = (float)(0.2 + 0.7 * (phase < 1.0 ? phase : 2.0 - phase));
+            }
+
+            // Parameters are passed every block, as the plugin does
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            engine.setParameters(parameters);
+            engine.process(block.getArrayOfWritePointers(), blockSize);
+            const auto endTicks = juce::Time::getHighResolutionTicks();
+
+            if (blockIndex >= 0)
+                blockSeconds.push_back(juce::Time::highResolutionTicksToSeconds(endTicks - startTicks));
+
+            outputPeak = juce::jmax(outputPeak, block.getMagnitude(0, blockSize));
+        }
+
+        const int latencySamples = engine.getLatencySamples();
+        engine.release();
+
+        const double totalSeconds = std::accumulate(blockSeconds.begin(), blockSeconds.end(), 0.0);
+        const double audioSeconds = (double)numBlocks * blockSize / sampleRate;
+        std::sort(blockSeconds.begin(), blockSeconds.end());
+
+        auto* blockTimes = new juce::DynamicObject();
+        blockTimes->setProperty("p50", percentile(blockSeconds, 0.5) * 1.0e6);
+        blockTimes->setProperty("p99", percentile(blockSeconds, 0.99) * 1.0e6);
+        blockTimes->setProperty("max", blockSeconds.back() * 1.0e6);
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("sampleRate", sampleRate);
+        result->setProperty("blockSize", blockSize);
+        result->setProperty("channels", numChannels);
+        result->setProperty("parameters", setting.name);
+        result->setProperty("precision", isDouble ? "double" : "single");
+        result->setProperty("latencySamples", latencySamples);
+        result->setProperty("blocks", numBlocks);
+        result->setProperty("nsPerSample", totalSeconds * 1.0e9 / ((double)numBlocks * blockSize));
+        result->setProperty("realtimeFactor", audioSeconds / totalSeconds);
+        result->setProperty("blockTimeMicroseconds", juce::var(blockTimes));
+        result->setProperty("outputPeak", (double)outputPeak);
+        return juce::var(result);
+    }
+
+    //==============================================================================
+    /** Times one band-shaping kernel on its own over numBands bands of 4096 samples. */
+    template <typename Kernel>
+    juce::var timeKernel(const juce::String& name, int numBands, Kernel&& kernel)
+    {
+        constexpr int numSamples = 4096;
+        constexpr int numRuns = 2000;
+
+        std::vector<float> input((size_t)numSamples);
+        juce::AudioBuffer<float> bands(numBands, numSamples);
+        juce::Random random(42);
+
+        for (auto& value : input)
+            value = random.nextFloat() * 2.0f - 1.0f;
+
+        double totalSeconds = 0.0;
+
+        for (int run = 0; run < numRuns; ++run)
+        {
+            for (int band = 0; band < numBands; ++band)
+                bands.copyFrom(band, 0, input.data(), numSamples);
+
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            kernel(bands.getArrayOfWritePointers(), input.data(), numSamples);
+            totalSeconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+        }
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("name", name);
+        result->setProperty("bands", numBands);
+        result->setProperty("nsPerSample", totalSeconds * 1.0e9 / ((double)numRuns * numSamples));
+        return juce::var(result);
+    }
+
+    juce::var runKernels()
+    {
+        juce::Array<juce::var> kernels;
+
+        // The default three bands, and all six to show what each extra band costs
+        for (int numBands : { 3, MultibandShaper::maxBands })
+        {
+            const auto layout = MultibandShaper::makeLayout(numBands, MultibandShaper::getDefaultShapes());
+            WaveshaperTableSet tables(MultibandShaper::getCurves(layout));
+            AdaaShaper adaaShaper;
+            adaaShaper.prepare(1);
+            adaaShaper.setLayout(layout);
+
+            kernels.add(timeKernel("reference", numBands, [&](float* const* bands, const float* input, int numSamples)
+            {
+                MultibandShaper::processReference(bands, input, numSamples, 0.5f, nullptr, layout);
+            }));
+
+            kernels.add(timeKernel("simd", numBands, [&](float* const* bands, const float* input, int numSamples)
+            {
+                MultibandShaper::process(bands, input, numSamples, 0.5f, nullptr, layout);
+            }));
+
+            auto lookupTable = timeKernel("lookupTable", numBands, [&](float* const* bands, const float* input, int numSamples)
+            {
+                MultibandShaper::processWithTables(bands, input, numSamples, 0.5f, nullptr, layout, tables.getTables());
+            });
+
+            // What the tables cost in cache and how far they are from the exact curves
+            lookupTable.getDynamicObject()->setProperty("tableBytes", (juce::int64)tables.getSizeInBytes());
+            lookupTable.getDynamicObject()->setProperty("tableMaxError", tables.getMaxError());
+            kernels.add(lookupTable);
+
+            kernels.add(timeKernel("adaa1stOrder", numBands, [&](float* const* bands, const float* input, int numSamples)
+            {
+                adaaShaper.process(0, bands, input, numSamples, 0.5f, nullptr, AdaaShaper::Order::first);
+            }));
+
+            kernels.add(timeKernel("adaa2ndOrder", numBands, [&](float* const* bands, const float* input, int numSamples)
+            {
+                adaaShaper.process(0, bands, input, numSamples, 0.5f, nullptr, AdaaShaper::Order::second);
+            }));
+        }
+
+        return kernels;
+    }
+
+    //==============================================================================
+    /** Times a FastMath function as scalar and SimdFloat code and its libm (or JUCE) counterpart
+        over numValues inputs spread across [lower, upper], logarithmically for wide positive
+        ranges. Also measures the largest absolute or relative error of both variants against
+        the reference evaluated in double precision.
+    */
+    template <typename Fast, typename Reference>
+    juce::var measureFastMath(const juce::String& name, double lower, double upper, bool relativeError, Fast&& fast, Reference&& reference)
+    {
+        constexpr int numValues = 1 << 14;
+        constexpr int numRuns = 200;
+        static_assert(numValues % SimdFloat::size == 0, "The SIMD loop has no remainder");
+
+        const bool logarithmic = lower > 0.0 && upper / lower > 1000.0;
+        std::vector<float> input((size_t)numValues), output((size_t)numValues);
+
+        for (int i = 0; i < numValues; ++i)
+        {
+            const double position = (double)i / (numValues - 1);
+            input[(size_t)i] = (float)(logarithmic ? lower * std::pow(upper / lower, position) : lower + (upper - lower) * position);
+        }
+
+        auto time = [&](auto&& loop)
+        {
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+
+            for (int run = 0; run < numRuns; ++run)
+                loop();
+
+            const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+            return seconds * 1.0e9 / ((double)numRuns * numValues);
+        };
+
+        auto getMaxError = [&]
+        {
+            double maxError = 0.0;
+
+            for (int i = 0; i < numValues; ++i)
+            {
+                const double expected = reference((double)input[(size_t)i]);
+                double error = std::abs((double)output[(size_t)i] - expected);
+
+                if (relativeError)
+                    error = expected != 0.0 ? error / std::abs(expected) : 0.0;
+
+                maxError = juce::jmax(maxError, error);
+            }
+
+            return maxError;
+        };
+
+        const double scalarNs = time([&]
+        {
+            for (int i = 0; i < numValues; ++i)
+                output[(size_t)i] = fast(input[(size_t)i]);
+        });
+
+        const double scalarError = getMaxError();
+
+        const double simdNs = time([&]
+        {
+            for (int i = 0; i < numValues; i += SimdFloat::size)
+                fast(SimdFloat::load(input.data() + i)).store(output.data() + i);
+        });
+
+        const double simdError = getMaxError();
+
+        const double referenceNs = time([&]
+        {
+            for (int i = 0; i < numValues; ++i)
+                output[(size_t)i] = reference(input[(size_t)i]);
+        });
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("name", name);
+        result->setProperty("lower", lower);
+        result->setProperty("upper", upper);
+        result->setProperty("error", relativeError ? "relative" : "absolute");
+        result->setProperty("maxErrorScalar", scalarError);
+        result->setProperty("maxErrorSimd", simdError);
+        result->setProperty("nsPerValueScalar", scalarNs);
+        result->setProperty("nsPerValueSimd", simdNs);
+        result->setProperty("nsPerValueReference", referenceNs);
+        return juce::var(result);
+    }
+
+    /** One entry per row of the error table in FastMath.h. */
+    juce::var runFastMath()
+    {
+        juce::Array<juce::var> results;
+        constexpr bool absolute = false, relative = true;
+
+        results.add(measureFastMath("log2", 0.5, 2.0, absolute,
+                                    [](auto x) { return FastMath::log2(x); }, [](auto x) { return std::log2(x); }));
+        results.add(measureFastMath("log2", 1.0e-30, 1.0e30, absolute,
+                                    [](auto x) { return FastMath::log2(x); }, [](auto x) { return std::log2(x); }));
+        results.add(measureFastMath("exp2", -126.0, 126.0, relative,
+                                    [](auto x) { return FastMath::exp2(x); }, [](auto x) { return std::exp2(x); }));
+        results.add(measureFastMath("log", 0.5, 2.0, absolute,
+                                    [](auto x) { return FastMath::log(x); }, [](auto x) { return std::log(x); }));
+        results.add(measureFastMath("exp", -10.0, 10.0, relative,
+                                    [](auto x) { return FastMath::exp(x); }, [](auto x) { return std::exp(x); }));
+        results.add(measureFastMath("exp", -87.0, 87.0, relative,
+                                    [](auto x) { return FastMath::exp(x); }, [](auto x) { return std::exp(x); }));
+
+        // |p log2 x| reaches 2.2 * 13.3, well inside the documented range
+        results.add(measureFastMath("pow(x, 2.2)", 1.0e-4, 1.0e4, relative,
+                                    [](auto x) { return FastMath::pow(x, 2.2f); }, [](auto x) { return std::pow(x, decltype(x)(2.2f)); }));
+
+        // Both ends and the middle of the documented exponent range
+        for (auto exponent : { 0.25f, 1.25f, 4.0f })
+        {
+            results.add(measureFastMath("signedPow(x, " + juce::String(exponent) + ")", -1.0, 1.0, relative,
+                                        [exponent](auto x) { return FastMath::signedPow(x, FastMath::Ops<decltype(x)>::splat(exponent)); },
+                                        [exponent](auto x) { return std::copysign(std::pow(std::abs(x), decltype(x)(exponent)), x); }));
+        }
+
+        results.add(measureFastMath("tanh", -10.0, 10.0, absolute,
+                                    [](auto x) { return FastMath::tanh(x); }, [](auto x) { return std::tanh(x); }));
+        results.add(measureFastMath("decibelsToGain", -100.0, 60.0, relative,
+                                    [](auto x) { return FastMath::decibelsToGain(x); }, [](auto x) { return juce::Decibels::decibelsToGain(x); }));
+        results.add(measureFastMath("gainToDecibels", 1.0e-5, 1.0e3, absolute,
+                                    [](auto x) { return FastMath::gainToDecibels(x); }, [](auto x) { return juce::Decibels::gainToDecibels(x); }));
+
+        return results;
+    }
+
+    //==============================================================================
+    /** Drives a steady 2.5 kHz sine at 44.1 kHz through the chain and measures how much of the
+        output lands away from the tone's harmonics, which below Nyquist is all aliasing.
+        Reports it in dB relative to the whole output, along with the chain's cost per sample.
+    */
+    juce::var measureAliasing(const ParameterSetting& setting)
+    {
+        constexpr double sampleRate = 44100.0;
+        constexpr double frequency = 2500.0;
+        constexpr int blockSize = 512;
+        constexpr int fftOrder = 14;
+        constexpr int fftSize = 1 << fftOrder;
+        constexpr int harmonicHalfWidth = 6; // Bins either side of a harmonic, covering the window's main lobe
+
+        constexpr int numChannels = 2;
+
+        DistroarEngine engine;
+        engine.setParameters(getParameters(setting));
+        engine.prepare(sampleRate, blockSize, numChannels);
+
+        // One second to let the ramps, compressors and oversampling latency settle, then the analysed part
+        const int numWarmupSamples = (int)sampleRate;
+        const int numSamples = numWarmupSamples + fftSize;
+        juce::AudioBuffer<float> block(numChannels, blockSize);
+        std::vector<float> output((size_t)(2 * fftSize), 0.0f);
+        double totalSeconds = 0.0;
+
+        for (int position = 0; position < numSamples; position += blockSize)
+        {
+            for (int sample = 0; sample < blockSize; ++sample)
+            {
+                const auto value = (float)(0.5 * std::sin(juce::MathConstants<double>::twoPi * frequency * (position + sample) / sampleRate));
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    block.setSample(channel, sample, value);
+            }
+
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            engine.process(block.getArrayOfWritePointers(), blockSize);
+            totalSeconds += juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+            for (int sample = 0; sample < blockSize; ++sample)
+            {
+                const int index = position + sample - numWarmupSamples;
+
+                if (juce::isPositiveAndBelow(index, fftSize))
+                    output[(size_t)index] = block.getSample(0, sample);
+            }
+        }
+
+        engine.release();
+
+        juce::dsp::WindowingFunction<float> window((size_t)fftSize, juce::dsp::WindowingFunction<float>::blackmanHarris, false);
+        window.multiplyWithWindowingTable(output.data(), (size_t)fftSize);
+        juce::dsp::FFT(fftOrder).performFrequencyOnlyForwardTransform(output.data(), true);
+
+        // DC and the harmonics below Nyquist are the wanted part of the distortion
+        const double binsPerHertz = fftSize / sampleRate;
+        double harmonicEnergy = 0.0, totalEnergy = 0.0;
+
+        for (int bin = 0; bin <= fftSize / 2; ++bin)
+        {
+            const double energy = (double)output[(size_t)bin] * output[(size_t)bin];
+            const double harmonic = bin / (frequency * binsPerHertz);
+            const double distance = std::abs(harmonic - std::round(harmonic)) * frequency * binsPerHertz;
+
+            totalEnergy += energy;
+
+            if (distance <= harmonicHalfWidth)
+                harmonicEnergy += energy;
+        }
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("name", setting.name);
+        result->setProperty("toneHz", frequency);
+        result->setProperty("sampleRate", sampleRate);
+        result->setProperty("nsPerSample", totalSeconds * 1.0e9 / numSamples);
+        result->setProperty("nonHarmonicDb", 10.0 * std::log10(juce::jmax(1.0e-20, (totalEnergy - harmonicEnergy) / totalEnergy)));
+        return juce::var(result);
+    }
+
+    juce::var runAliasing()
+    {
+        juce::Array<juce::var> results;
+
+        for (auto& setting : aliasingSettings)
+        {
+            results.add(measureAliasing(setting));
+            std::cerr << "." << std::flush;
+        }
+
+        std::cerr << std::endl;
+        return results;
+    }
+
+    //==============================================================================
+    /** Times the audio thread's part of a stereo convolution with a decaying noise response,
+        with the tail on its worker, and reports how many tail blocks missed their deadline.
+    */
+    juce::var timeConvolution(double impulseResponseSeconds, int blockSize)
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr double audioSeconds = 4.0;
+
+        const int length = (int)(impulseResponseSeconds * sampleRate);
+        juce::AudioBuffer<float> impulseResponse(2, length);
+        juce::Random random(42);
+
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < length; ++i)
+                impulseResponse.setSample(channel, i, (random.nextFloat() * 2.0f - 1.0f) * std::exp(-4.0f * (float)i / (float)length) * 0.05f);
+
+        PartitionedConvolution convolution(impulseResponse, 2, true);
+        juce::AudioBuffer<float> block(2, blockSize);
+        const int numBlocks = (int)(audioSeconds * sampleRate) / blockSize;
+        const double blockSeconds = blockSize / sampleRate;
+        std::vector<double> blockTimes;
+        blockTimes.reserve((size_t)numBlocks);
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            for (int channel = 0; channel < 2; ++channel)
+                for (int sample = 0; sample < blockSize; ++sample)
+                    block.setSample(channel, sample, random.nextFloat() * 2.0f - 1.0f);
+
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            convolution.process(block.getArrayOfWritePointers(), blockSize);
+            const double seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+            blockTimes.push_back(seconds * 1.0e6);
+
+            // Leave the worker the rest of the block period, as a realtime host would
+            juce::Thread::sleep(juce::jmax(0, (int)((blockSeconds - seconds) * 1000.0)));
+        }
+
+        const double totalMicroseconds = std::accumulate(blockTimes.begin(), blockTimes.end(), 0.0);
+        std::sort(blockTimes.begin(), blockTimes.end());
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("impulseResponseSeconds", impulseResponseSeconds);
+        result->setProperty("blockSize", blockSize);
+        result->setProperty("nsPerSample", totalMicroseconds * 1.0e3 / ((double)numBlocks * blockSize));
+        result->setProperty("p99BlockMicroseconds", percentile(blockTimes, 0.99));
+        result->setProperty("maxBlockMicroseconds", blockTimes.back());
+        result->setProperty("missedDeadlines", convolution.getNumMissedDeadlines());
+        return juce::var(result);
+    }
+
+    juce::var runConvolutions(bool quick)
+    {
+        juce::Array<juce::var> results;
+
+        // The audio thread's cost should stay flat as the response grows
+        for (double seconds : { 0.02, 0.1, 0.5, 1.0, 3.0 })
+        {
+            for (int blockSize : { 64, 512 })
+            {
+                results.add(timeConvolution(seconds, blockSize));
+                std::cerr << "." << std::flush;
+
+                if (quick)
+                    break;
+            }
+        }
+
+        std::cerr << std::endl;
+        return results;
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    const juce::ArgumentList arguments(argc, argv);
+
+    const bool quick = arguments.containsOption("--quick");
+    const double secondsPerCase = arguments.containsOption("--seconds")
+                                    ? arguments.getValueForOption("--seconds").getDoubleValue()
+                                    : (quick ? 1.0 : 4.0);
+
+    const juce::Array<double> sampleRates = quick ? juce::Array<double> { 48000.0 }
+                                                  : juce::Array<double> { 44100.0, 48000.0, 96000.0, 192000.0 };
+    const juce::Array<int> blockSizes = quick ? juce::Array<int> { 64, 512 }
+                                              : juce::Array<int> { 16, 64, 256, 1024, 4096 };
+    const juce::Array<int> channelCounts = quick ? juce::Array<int> { 2 } : juce::Array<int> { 1, 2 };
+
+    juce::Array<juce::var> cases;
+
+    for (auto sampleRate : sampleRates)
+        for (auto blockSize : blockSizes)
+            for (auto numChannels : channelCounts)
+                for (auto& setting : parameterSettings)
+                {
+                    for (auto result : { runCase<float>(sampleRate, blockSize, numChannels, setting, secondsPerCase),
+                                         runCase<double>(sampleRate, blockSize, numChannels, setting, secondsPerCase) })
+                    {
+                        if (! result.isVoid())
+                            cases.add(result);
+                    }
+
+                    std::cerr << "." << std::flush;
+                }
+
+    std::cerr << std::endl;
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("plugin", "DISTROAR");
+    report->setProperty("juce", juce::SystemStats::getJUCEVersion());
+    report->setProperty("cpu", juce::SystemStats::getCpuModel());
+    report->setProperty("cpuCores", juce::SystemStats::getNumPhysicalCpus());
+    report->setProperty("simdWidth", SimdFloat::size);
+   #if JUCE_DEBUG
+    report->setProperty("build", "debug");
+   #else
+    report->setProperty("build", "release");
+   #endif
+    report->setProperty("secondsPerCase", secondsPerCase);
+    report->setProperty("cases", cases);
+    report->setProperty("kernels", runKernels());
+    report->setProperty("fastMath", runFastMath());
+    report->setProperty("aliasing", runAliasing());
+    report->setProperty("convolution", runConvolutions(quick));
+
+    const auto json = juce::JSON::toString(juce::var(report));
+
+    if (arguments.containsOption("--output"))
+    {
+        const auto outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(arguments.getValueForOption("--output"));
+
+        if (! outputFile.replaceWithText(json))
+        {
+            std::cerr << "Could not write " << outputFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        std::cout << json << std::endl;
+    }
+
+    return 0;
+}
@@ -32,7 +32,7 @@
  #define JucePlugin_Build_Unity            0
 #endif
 #ifndef  JucePlugin_Build_LV2
- #define JucePlugin_Build_LV2              0
+ #define JucePlugin_Build_LV2              1
 #endif
 #ifndef  JucePlugin_Enable_IAA
  #define JucePlugin_Enable_IAA             0
@@ -160,3 +160,6 @@
 #ifndef  JucePlugin_ARACompatibleArchiveIDs
  #define JucePlugin_ARACompatibleArchiveIDs  ""
 #endif
+#ifndef  JucePlugin_LV2URI
+ #define JucePlugin_LV2URI                 "https://github.com/melinteflxrin/DISTROAR-Distortion-Plugin"
+#endif
@@ -0,0 +1,617 @@
+/*
+    distroar-render: offline batch rendering through the DISTROAR processing chain.
+
+    Every input file (WAV, AIFF, FLAC, ...) is rendered through a DistroarEngine and
+    written as a WAV file. Files are handed out to a fixed set of worker threads, each
+    of which owns one engine, so all cores are kept busy.
+
+    With --chunk-seconds, files are instead rendered one at a time, split into chunks
+    that run in parallel. Each chunk's engine starts pre-roll seconds early so its
+    filters, compressors and gate envelopes have settled by the time its output is kept.
+
+    Engines run in non-realtime mode, so a cabinet impulse response is convolved
+    entirely on the rendering thread and the output does not depend on timing.
+
+    Usage: distroar-render [options] <input files...>
+
+        --list=<file>           Text file with one input path per line, in addition to the arguments
+        --output-dir=<dir>      Where to write the results (default: next to each input)
+        --suffix=<text>         Appended to each output file name (default: _distroar),
+                                may only be empty if no output would replace its input
+        --parameters=<file>     JSON object with any of the parameter keys below
+        --threads=<n>           Number of worker threads (default: one per CPU core)
+        --block-size=<n>        Processing block size (default: 512)
+
+        --chunk-seconds=<s>     Split each file into chunks of this length and render them in parallel
+        --preroll-seconds=<s>   Audio run through each chunk's engine before its output is kept (default: 2),
+                                plus the impulse response length limit if there is one
+        --verify                Also render each chunked file serially and report the largest difference
+
+        --drive=<0..1> --blend=<0..1> --volume=<0..1> --tone=<Hz> --gate=<dB>
+        --gateLink=<0|1> --shaper=<direct|table> --oversampling=<1|2|4|8>
+        --linearPhase=<0|1> --adaa=<0|1|2> --crossover=<iir|linear>
+        --lowCrossover=<Hz> --highCrossover=<Hz> --bands=<2..6>
+        --band<n>Drive=<0..2> --band<n>Clip=<0.05..1> --band<n>Exponent=<0.25..2.5>   (n = 1..6)
+
+        --ir=<file>             Cabinet impulse response (WAV, AIFF, FLAC, ...) replacing the built-in voicing
+        --irLength=<s>          Longest part of the impulse response used (0.01..3, default: 0.5)
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "../../Source/DistroarEngine.h"
+
+namespace
+{
+    //==============================================================================
+    /** Applies every known key found in values (a JSON object or the command line) to parameters. */
+    template <typename Lookup>
+    void applyParameterValues(DistroarEngine::Parameters& parameters, Lookup&& lookup)
+    {
+        juce::String value;
+
+        if (lookup("drive", value))        parameters.drive = juce::jlimit(0.0f, 1.0f, value.getFloatValue());
+        if (lookup("blend", value))        parameters.blend = juce::jlimit(0.0f, 1.0f, value.getFloatValue());
+        if (lookup("volume", value))       parameters.volume = juce::jlimit(0.0f, 1.0f, value.getFloatValue());
+        if (lookup("tone", value))         parameters.tone = juce::jlimit(600.0f, 20000.0f, value.getFloatValue());
+        if (lookup("gate", value))         parameters.gateThreshold = juce::jlimit(-90.0f, 0.0f, value.getFloatValue());
+        if (lookup("lowCrossover", value)) parameters.lowCrossover = juce::jlimit(DistroarEngine::Parameters::minLowCrossover, DistroarEngine::Parameters::maxLowCrossover, value.getFloatValue());
+        if (lookup("highCrossover", value)) parameters.highCrossover = juce::jlimit(DistroarEngine::Parameters::minHighCrossover, DistroarEngine::Parameters::maxHighCrossover, value.getFloatValue());
+        if (lookup("gateLink", value))     parameters.gateLinked = value.getIntValue() != 0;
+        if (lookup("shaper", value))       parameters.useLookupTables = value.equalsIgnoreCase("table");
+        if (lookup("linearPhase", value))  parameters.linearPhaseOversampling = value.getIntValue() != 0;
+        if (lookup("adaa", value))         parameters.antiAliasing = juce::jlimit(0, 2, value.getIntValue());
+        if (lookup("crossover", value))    parameters.linearPhaseCrossover = value.equalsIgnoreCase("linear");
+        if (lookup("bands", value))        parameters.numBands = juce::jlimit(MultibandShaper::minBands, MultibandShaper::maxBands, value.getIntValue());
+
+        for (int band = 0; band < MultibandShaper::maxBands; ++band)
+        {
+            const auto prefix = "band" + juce::String(band + 1);
+            auto& shape = parameters.bandShapes[(size_t)band];
+
+            if (lookup(prefix + "Drive", value))    shape.drive = juce::jlimit(0.0f, BandShape::maxDrive, value.getFloatValue());
+            if (lookup(prefix + "Clip", value))     shape.clipLevel = juce::jlimit(BandShape::minClipLevel, BandShape::maxClipLevel, value.getFloatValue());
+            if (lookup(prefix + "Exponent", value)) shape.exponent = juce::jlimit(BandShape::minExponent, BandShape::maxExponent, value.getFloatValue());
+        }
+
+        if (lookup("oversampling", value))
+        {
+            const int factor = juce::nextPowerOfTwo(juce::jmax(1, value.getIntValue()));
+            parameters.oversamplingStages = juce::jlimit(0, DistroarEngine::maxOversamplingStages, juce::roundToInt(std::log2(factor)));
+        }
+    }
+
+    //==============================================================================
+    struct RenderJob
+    {
+        DistroarEngine::Parameters parameters;
+        CabinetImpulseResponse::Settings impulseResponse;
+        juce::Array<juce::File> inputFiles;
+        juce::File outputDirectory;
+        juce::String suffix = "_distroar";
+        int blockSize = 512;
+        double chunkSeconds = 0.0;  // 0 renders every file serially
+        double preRollSeconds = 2.0;
+        bool verify = false;
+
+        juce::File getOutputFile(const juce::File& input) const
+        {
+            const auto directory = outputDirectory == juce::File() ? input.getParentDirectory() : outputDirectory;
+            return directory.getChildFile(input.getFileNameWithoutExtension() + suffix + ".wav");
+        }
+    };
+
+    //==============================================================================
+    /**
+        Pulls rendered samples out of an engine fed from a reader.
+
+        The engine is prepared fresh and fed from inputStart, but nothing is returned
+        until the output for outputStart comes out, so the engine's latency and any
+        pre-roll are skipped. Reads past the end of the file feed silence.
+    */
+    class StreamRenderer
+    {
+    public:
+        StreamRenderer(DistroarEngine& engineToUse, juce::AudioFormatReader& source, const RenderJob& job,
+                       juce::int64 inputStart, juce::int64 outputStart)
+            : engine(engineToUse), reader(source), numChannels((int)source.numChannels), blockSize(job.blockSize),
+              inputPosition(inputStart)
+        {
+            jassert(inputStart <= outputStart);
+
+            engine.setNonRealtime(true);
+            engine.setParameters(job.parameters);
+            engine.setImpulseResponse(job.impulseResponse);
+            engine.prepare(reader.sampleRate, blockSize, numChannels);
+            block.setSize(numChannels, blockSize);
+            samplesToSkip = outputStart - inputStart + engine.getLatencySamples();
+        }
+
+        /** Renders the next numSamples output samples into destination, starting at destinationStart. */
+        bool render(juce::AudioBuffer<float>& destination, int destinationStart, int numSamples)
+        {
+            while (numSamples > 0)
+            {
+                const bool skipping = samplesToSkip > 0;
+                const int numBlockSamples = (int)juce::jmin((juce::int64)blockSize, skipping ? samplesToSkip : (juce::int64)numSamples);
+
+                block.clear();
+
+                if (! reader.read(&block, 0, numBlockSamples, inputPosition, true, numChannels > 1))
+                    return false;
+
+                engine.process(block.getArrayOfWritePointers(), numBlockSamples);
+                inputPosition += numBlockSamples;
+
+                if (skipping)
+                {
+                    samplesToSkip -= numBlockSamples;
+                    continue;
+                }
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    destination.copyFrom(channel, destinationStart, block, channel, 0, numBlockSamples);
+
+                destinationStart += numBlockSamples;
+                numSamples -= numBlockSamples;
+            }
+
+            return true;
+        }
+
+    private:
+        DistroarEngine& engine;
+        juce::AudioFormatReader& reader;
+        const int numChannels, blockSize;
+        juce::int64 inputPosition, samplesToSkip = 0;
+        juce::AudioBuffer<float> block;
+
+        JUCE_DECLARE_NON_COPYABLE(StreamRenderer)
+    };
+
+    std::unique_ptr<juce::AudioFormatWriter> createWriter(const juce::File& output, const juce::AudioFormatReader& reader)
+    {
+        output.deleteFile();
+        std::unique_ptr<juce::FileOutputStream> stream(output.createOutputStream());
+
+        if (stream == nullptr)
+            return {};
+
+        const int bitsPerSample = reader.usesFloatingPointData ? 32 : juce::jlimit(16, 24, (int)reader.bitsPerSample);
+        std::unique_ptr<juce::AudioFormatWriter> writer(juce::WavAudioFormat().createWriterFor(stream.get(), reader.sampleRate,
+                                                                                              reader.numChannels, bitsPerSample, {}, 0));
+        if (writer != nullptr)
+            stream.release(); // Now owned by the writer
+
+        return writer;
+    }
+
+    juce::String checkFormat(const juce::File& input, const juce::AudioFormatReader* reader)
+    {
+        if (reader == nullptr)
+            return input.getFullPathName() + ": unsupported or unreadable file";
+
+        if (reader->numChannels < 1 || reader->numChannels > 2)
+            return input.getFullPathName() + ": only mono and stereo files are supported";
+
+        return {};
+    }
+
+    juce::String describeSpeed(double audioSeconds, double startMilliseconds)
+    {
+        const double seconds = (juce::Time::getMillisecondCounterHiRes() - startMilliseconds) / 1000.0;
+        return juce::String(audioSeconds / juce::jmax(seconds, 1.0e-6), 1) + "x realtime";
+    }
+
+    /** One worker thread with its own engine, pulling files off the shared job list until it is empty. */
+    class RenderWorker : public juce::Thread
+    {
+    public:
+        RenderWorker(const RenderJob& jobToRun, std::atomic<int>& nextFileIndex, std::atomic<int>& numFailures, juce::CriticalSection& logLock)
+            : juce::Thread("DISTROAR Render"), job(jobToRun), nextFile(nextFileIndex), failures(numFailures), outputLock(logLock)
+        {
+            formatManager.registerBasicFormats();
+        }
+
+        ~RenderWorker() override
+        {
+            stopThread(-1);
+        }
+
+        void run() override
+        {
+            for (int index = nextFile++; index < job.inputFiles.size() && ! threadShouldExit(); index = nextFile++)
+            {
+                const auto& input = job.inputFiles.getReference(index);
+                const auto message = renderFile(input);
+
+                const juce::ScopedLock sl(outputLock);
+                std::cerr << "[" << (index + 1) << "/" << job.inputFiles.size() << "] " << message << std::endl;
+            }
+        }
+
+    private:
+        juce::String renderFile(const juce::File& input)
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+            const auto error = checkFormat(input, reader.get());
+
+            if (error.isNotEmpty())
+                return fail(error);
+
+            const auto output = job.getOutputFile(input);
+            auto writer = createWriter(output, *reader);
+
+            if (writer == nullptr)
+                return fail(output.getFullPathName() + ": cannot be written");
+
+            StreamRenderer renderer(engine, *reader, job, 0, 0);
+            juce::AudioBuffer<float> block((int)reader->numChannels, job.blockSize);
+            const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+            for (juce::int64 position = 0; position < reader->lengthInSamples && ! threadShouldExit(); position += job.blockSize)
+            {
+                const int numSamples = (int)juce::jmin((juce::int64)job.blockSize, reader->lengthInSamples - position);
+
+                if (! renderer.render(block, 0, numSamples) || ! writer->writeFromAudioSampleBuffer(block, 0, numSamples))
+                    return fail(output.getFullPathName() + ": render failed");
+            }
+
+            return input.getFileName() + " -> " + output.getFullPathName()
+                 + " (" + describeSpeed((double)reader->lengthInSamples / reader->sampleRate, startTime) + ")";
+        }
+
+        juce::String fail(const juce::String& message)
+        {
+            ++failures;
+            return "FAILED " + message;
+        }
+
+        const RenderJob& job;
+        std::atomic<int>& nextFile;
+        std::atomic<int>& failures;
+        juce::CriticalSection& outputLock;
+
+        juce::AudioFormatManager formatManager;
+        DistroarEngine engine;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RenderWorker)
+    };
+
+    //==============================================================================
+    /**
+        Renders one file at a time, split into chunks that run on a thread pool.
+
+        Each chunk gets a fresh engine started preRoll samples before the chunk, and
+        only the chunk's own samples are kept. Finished chunks are written in order
+        as soon as they are ready, so only a few are held in memory at once.
+    */
+    class ChunkedRenderer
+    {
+    public:
+        ChunkedRenderer(const RenderJob& jobToRun, int numThreads)
+            : job(jobToRun), pool(numThreads)
+        {
+            for (int i = 0; i < numThreads; ++i)
+            {
+                auto* context = contexts.add(new WorkerContext());
+                context->formatManager.registerBasicFormats();
+                freeContexts.add(context);
+            }
+
+            formatManager.registerBasicFormats();
+        }
+
+        /** Returns false if the file could not be rendered. */
+        bool renderFile(const juce::File& input, juce::String& message)
+        {
+            std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+            message = checkFormat(input, reader.get());
+
+            if (message.isNotEmpty())
+                return false;
+
+            const auto output = job.getOutputFile(input);
+            auto writer = createWriter(output, *reader);
+
+            if (writer == nullptr)
+            {
+                message = output.getFullPathName() + ": cannot be written";
+                return false;
+            }
+
+            const auto length = reader->lengthInSamples;
+            const auto chunkLength = juce::jmax((juce::int64)job.blockSize, (juce::int64)(job.chunkSeconds * reader->sampleRate));
+            const double impulseResponseSeconds = job.impulseResponse.file != juce::File() ? job.impulseResponse.lengthLimitSeconds : 0.0;
+            const auto preRoll = (juce::int64)((job.preRollSeconds + impulseResponseSeconds) * reader->sampleRate);
+            const int numChunks = (int)((length + chunkLength - 1) / chunkLength);
+            const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+            std::vector<juce::AudioBuffer<float>> chunks((size_t)numChunks);
+            std::unique_ptr<std::atomic<bool>[]> finished(new std::atomic<bool>[(size_t)numChunks]);
+            std::atomic<bool> failed { false };
+
+            for (int i = 0; i < numChunks; ++i)
+            {
+                finished[(size_t)i] = false;
+
+                pool.addJob([&, i]
+                {
+                    const auto start = (juce::int64)i * chunkLength;
+                    const auto numSamples = (int)juce::jmin(chunkLength, length - start);
+                    auto* context = acquireContext();
+
+                    std::unique_ptr<juce::AudioFormatReader> chunkReader(context->formatManager.createReaderFor(input));
+
+                    if (chunkReader != nullptr)
+                    {
+                        StreamRenderer renderer(context->engine, *chunkReader, job, juce::jmax((juce::int64)0, start - preRoll), start);
+                        chunks[(size_t)i].setSize((int)chunkReader->numChannels, numSamples);
+
+                        if (! renderer.render(chunks[(size_t)i], 0, numSamples))
+                            failed = true;
+                    }
+                    else
+                    {
+                        failed = true;
+                    }
+
+                    releaseContext(context);
+                    finished[(size_t)i] = true;
+                    chunkFinished.signal();
+                });
+            }
+
+            // A serial render of the whole file, advanced alongside the writes, to measure the stitching error
+            DistroarEngine referenceEngine;
+            std::unique_ptr<StreamRenderer> reference;
+            juce::AudioBuffer<float> referenceBuffer;
+            double maxDeviation = 0.0, squaredDeviation = 0.0;
+
+            if (job.verify)
+                reference = std::make_unique<StreamRenderer>(referenceEngine, *reader, job, 0, 0);
+
+            for (int i = 0; i < numChunks; ++i)
+            {
+                while (! finished[(size_t)i])
+                    chunkFinished.wait(100);
+
+                auto& chunk = chunks[(size_t)i];
+
+                if (failed || ! writer->writeFromAudioSampleBuffer(chunk, 0, chunk.getNumSamples()))
+                {
+                    pool.removeAllJobs(true, -1);
+                    message = output.getFullPathName() + ": render failed";
+                    return false;
+                }
+
+                if (reference != nullptr)
+                {
+                    referenceBuffer.setSize(chunk.getNumChannels(), chunk.getNumSamples(), false, false, true);
+                    reference->render(referenceBuffer, 0, chunk.getNumSamples());
+
+                    for (int channel = 0; channel < chunk.getNumChannels(); ++channel)
+                    {
+                        auto* chunkData = chunk.getReadPointer(channel);
+                        auto* referenceData = referenceBuffer.getReadPointer(channel);
+
+                        for (int sample = 0; sample < chunk.getNumSamples(); ++sample)
+                        {
+                            const double difference = std::abs((double)chunkData[sample] - (double)referenceData[sample]);
+                            maxDeviation = juce::jmax(maxDeviation, difference);
+                            squaredDeviation += difference * difference;
+                        }
+                    }
+                }
+
+                chunk.setSize(0, 0);
+            }
+
+            message = input.getFileName() + " -> " + output.getFullPathName() + " (" + juce::String(numChunks) + " chunks, "
+                    + describeSpeed((double)length / reader->sampleRate, startTime) + ")";
+
+            if (reference != nullptr)
+            {
+                const double rmsDeviation = std::sqrt(squaredDeviation / juce::jmax(1.0, (double)length * reader->numChannels));
+                message << ", deviation from serial render: max "
+                        << juce::String(juce::Decibels::gainToDecibels(maxDeviation, -200.0), 1) << " dBFS, rms "
+                        << juce::String(juce::Decibels::gainToDecibels(rmsDeviation, -200.0), 1) << " dBFS";
+            }
+
+            return true;
+        }
+
+    private:
+        struct WorkerContext
+        {
+            DistroarEngine engine;
+            juce::AudioFormatManager formatManager;
+        };
+
+        // The pool never runs more jobs than there are contexts, so one is always free
+        WorkerContext* acquireContext()
+        {
+            const juce::ScopedLock sl(contextLock);
+            jassert(! freeContexts.isEmpty());
+            return freeContexts.removeAndReturn(freeContexts.size() - 1);
+        }
+
+        void releaseContext(WorkerContext* context)
+        {
+            const juce::ScopedLock sl(contextLock);
+            freeContexts.add(context);
+        }
+
+        const RenderJob& job;
+        juce::AudioFormatManager formatManager;
+        juce::OwnedArray<WorkerContext> contexts;
+        juce::Array<WorkerContext*> freeContexts;
+        juce::CriticalSection contextLock;
+        juce::WaitableEvent chunkFinished;
+        juce::ThreadPool pool;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChunkedRenderer)
+    };
+
+    //==============================================================================
+    int printUsage()
+    {
+        std::cerr << "Usage: distroar-render [--list=<file>] [--output-dir=<dir>] [--suffix=<text>] [--parameters=<file.json>]" << std::endl
+                  << "                       [--threads=<n>] [--block-size=<n>] [--drive=<0..1>] [--blend=<0..1>] [--volume=<0..1>]" << std::endl
+                  << "                       [--tone=<Hz>] [--gate=<dB>] [--gateLink=<0|1>] [--shaper=<direct|table>]" << std::endl
+                  << "                       [--oversampling=<1|2|4|8>] [--linearPhase=<0|1>] [--adaa=<0|1|2>]" << std::endl
+                  << "                       [--crossover=<iir|linear>] [--lowCrossover=<Hz>] [--highCrossover=<Hz>] [--bands=<2..6>]" << std::endl
+                  << "                       [--band<n>Drive=<0..2>] [--band<n>Clip=<0.05..1>] [--band<n>Exponent=<0.25..2.5>]" << std::endl
+                  << "                       [--ir=<file> [--irLength=<s>]]" << std::endl
+                  << "                       [--chunk-seconds=<s> [--preroll-seconds=<s>] [--verify]] <input files...>" << std::endl;
+        return 1;
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    const juce::ArgumentList arguments(argc, argv);
+    RenderJob job;
+
+    if (arguments.containsOption("--parameters"))
+    {
+        const auto parameterFile = juce::File::getCurrentWorkingDirectory().getChildFile(arguments.getValueForOption("--parameters"));
+        const auto json = juce::JSON::parse(parameterFile);
+
+        if (! json.isObject())
+        {
+            std::cerr << parameterFile.getFullPathName() << " is not a JSON object" << std::endl;
+            return 1;
+        }
+
+        applyParameterValues(job.parameters, [&](const juce::String& key, juce::String& value)
+        {
+            if (! json.hasProperty(key))
+                return false;
+
+            value = json[key].toString();
+            return true;
+        });
+    }
+
+    // Options on the command line override the parameter file
+    applyParameterValues(job.parameters, [&](const juce::String& key, juce::String& value)
+    {
+        const auto option = "--" + key;
+
+        if (! arguments.containsOption(option))
+            return false;
+
+        value = arguments.getValueForOption(option);
+        return true;
+    });
+
+    if (arguments.containsOption("--ir"))
+    {
+        job.impulseResponse.file = juce::File::getCurrentWorkingDirectory().getChildFile(arguments.getValueForOption("--ir"));
+
+        if (! job.impulseResponse.file.existsAsFile())
+        {
+            std::cerr << job.impulseResponse.file.getFullPathName() << " does not exist" << std::endl;
+            return 1;
+        }
+    }
+
+    if (arguments.containsOption("--irLength"))
+        job.impulseResponse.lengthLimitSeconds = juce::jlimit(CabinetImpulseResponse::minLengthLimitSeconds, CabinetImpulseResponse::maxLengthLimitSeconds,
+                                                              arguments.getValueForOption("--irLength").getDoubleValue());
+
+    if (arguments.containsOption("--output-dir"))
+    {
+        job.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(arguments.getValueForOption("--output-dir"));
+
+        if (! job.outputDirectory.createDirectory())
+        {
+            std::cerr << "Cannot create " << job.outputDirectory.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    if (arguments.containsOption("--suffix"))
+        job.suffix = arguments.getValueForOption("--suffix");
+
+    if (arguments.containsOption("--block-size"))
+        job.blockSize = juce::jlimit(16, 65536, arguments.getValueForOption("--block-size").getIntValue());
+
+    if (arguments.containsOption("--chunk-seconds"))
+        job.chunkSeconds = juce::jmax(0.0, arguments.getValueForOption("--chunk-seconds").getDoubleValue());
+
+    if (arguments.containsOption("--preroll-seconds"))
+        job.preRollSeconds = juce::jmax(0.0, arguments.getValueForOption("--preroll-seconds").getDoubleValue());
+
+    job.verify = arguments.containsOption("--verify");
+
+    for (auto& argument : arguments.arguments)
+        if (! argument.isOption())
+            job.inputFiles.add(argument.resolveAsFile());
+
+    if (arguments.containsOption("--list"))
+    {
+        juce::StringArray lines;
+        juce::File::getCurrentWorkingDirectory().getChildFile(arguments.getValueForOption("--list")).readLines(lines);
+
+        for (auto& line : lines)
+            if (line.trim().isNotEmpty())
+                job.inputFiles.add(juce::File::getCurrentWorkingDirectory().getChildFile(line.trim()));
+    }
+
+    if (job.inputFiles.isEmpty())
+        return printUsage();
+
+    // Writing an output first deletes it, so an input must never be its own output
+    for (auto& input : job.inputFiles)
+    {
+        if (job.getOutputFile(input) == input)
+        {
+            std::cerr << input.getFullPathName() << " would be overwritten by its output, use --output-dir or a --suffix" << std::endl;
+            return 1;
+        }
+    }
+
+    const int requestedThreads = arguments.containsOption("--threads") ? arguments.getValueForOption("--threads").getIntValue()
+                                                                       : juce::SystemStats::getNumCpus();
+
+    if (job.chunkSeconds > 0.0)
+    {
+        ChunkedRenderer renderer(job, juce::jmax(1, requestedThreads));
+        int numFailures = 0;
+
+        for (int i = 0; i < job.inputFiles.size(); ++i)
+        {
+            juce::String message;
+
+            if (! renderer.renderFile(job.inputFiles.getReference(i), message))
+            {
+                ++numFailures;
+                message = "FAILED " + message;
+            }
+
+            std::cerr << "[" << (i + 1) << "/" << job.inputFiles.size() << "] " << message << std::endl;
+        }
+
+        std::cerr << (job.inputFiles.size() - numFailures) << " of " << job.inputFiles.size() << " files rendered" << std::endl;
+        return numFailures == 0 ? 0 : 1;
+    }
+
+    const int numThreads = juce::jlimit(1, job.inputFiles.size(), requestedThreads);
+    std::atomic<int> nextFile { 0 };
+    std::atomic<int> numFailures { 0 };
+    juce::CriticalSection outputLock;
+
+    juce::OwnedArray<RenderWorker> workers;
+
+    for (int i = 0; i < numThreads; ++i)
+        workers.add(new RenderWorker(job, nextFile, numFailures, outputLock))->startThread();
+
+    for (auto* worker : workers)
+        worker->waitForThreadToExit(-1);
+
+    std::cerr << (job.inputFiles.size() - numFailures.load()) << " of " << job.inputFiles.size() << " files rendered" << std::endl;
+    return numFailures.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+#include "AdaaShaper.h"
+
+namespace
+{
+    // Below this input difference the antiderivative quotients lose too much precision
+    constexpr double illConditionedTolerance = 1.0e-5;
+}
+
+//==============================================================================
+AdaaShaper::Curve::Curve(const ShaperCurve& curve) noexcept
+    : clipLevel(curve.clipLevel), exponent(curve.exponent), outputScale(curve.outputScale)
+{
+    clipPower = std::pow(clipLevel, exponent);
+    clipIntegral1 = clipPower * clipLevel / (exponent + 1.0);
+    clipIntegral2 = clipIntegral1 * clipLevel / (exponent + 2.0);
+}
+
+double AdaaShaper::Curve::evaluate(double x) const noexcept
+{
+    const double magnitude = std::pow(juce::jmin(std::abs(x), clipLevel), exponent);
+    return std::copysign(magnitude * outputScale, x);
+}
+
+double AdaaShaper::Curve::antiderivative1(double x) const noexcept
+{
+    // Even function: integral of the odd curve from 0
+    const double a = std::abs(x);
+
+    if (a <= clipLevel)
+        return outputScale * std::pow(a, exponent + 1.0) / (exponent + 1.0);
+
+    return outputScale * (clipIntegral1 + clipPower * (a - clipLevel));
+}
+
+double AdaaShaper::Curve::antiderivative2(double x) const noexcept
+{
+    // Odd function: integral of antiderivative1 from 0
+    const double a = std::abs(x);
+    double result;
+
+    if (a <= clipLevel)
+    {
+        result = std::pow(a, exponent + 2.0) / ((exponent + 1.0) * (exponent + 2.0));
+    }
+    else
+    {
+        const double excess = a - clipLevel;
+        result = clipIntegral2 + clipIntegral1 * excess + 0.5 * clipPower * excess * excess;
+    }
+
+    return std::copysign(outputScale * result, x);
+}
+
+//==============================================================================
+AdaaShaper::AdaaShaper()
+{
+    setLayout(MultibandShaper::makeLayout(3, MultibandShaper::getDefaultShapes()));
+}
+
+void AdaaShaper::setLayout(const MultibandShaper::Layout& newLayout) noexcept
+{
+    layout = newLayout;
+    const auto newCurves = MultibandShaper::getCurves(layout);
+
+    for (size_t band = 0; band < curves.size(); ++band)
+    {
+        if (newCurves[band] == shaperCurves[band])
+            continue;
+
+        shaperCurves[band] = newCurves[band];
+        curves[band] = Curve(newCurves[band]);
+
+        // Re-evaluate the stored antiderivatives so the next quotient doesn't mix two curves
+        for (auto& channelStates : states)
+        {
+            auto& state = channelStates[band];
+            state.ad1 = curves[band].antiderivative1(state.x1);
+            state.ad2 = curves[band].antiderivative2(state.x1);
+        }
+    }
+}
+
+void AdaaShaper::prepare(int numChannels)
+{
+    states.resize((size_t)numChannels);
+    reset();
+}
+
+void AdaaShaper::reset() noexcept
+{
+    for (auto& channelStates : states)
+        for (auto& state : channelStates)
+            state = {};
+}
+
+double AdaaShaper::processFirstOrder(const Curve& curve, BandState& state, double x) noexcept
+{
+    const double ad1 = curve.antiderivative1(x);
+    const double delta = x - state.x1;
+
+    const double y = std::abs(delta) < illConditionedTolerance ? curve.evaluate(0.5 * (x + state.x1))
+                                                               : (ad1 - state.ad1) / delta;
+    state.x1 = x;
+    state.ad1 = ad1;
+    return y;
+}
+
+double AdaaShaper::processSecondOrder(const Curve& curve, BandState& state, double x) noexcept
+{
+    const double ad2 = curve.antiderivative2(x);
+    const double delta = x - state.x1;
+
+    // First difference quotient of the second antiderivative between x1 and x
+    const double d0 = std::abs(delta) < illConditionedTolerance ? curve.antiderivative1(0.5 * (x + state.x1))
+                                                                : (ad2 - state.ad2) / delta;
+    double y;
+
+    if (std::abs(x - state.x2) < illConditionedTolerance)
+    {
+        // x and x2 nearly coincide: take the limit with both at their midpoint, which is
+        // well conditioned as long as x1 is apart from it
+        const double xBar = 0.5 * (x + state.x2);
+        const double spread = xBar - state.x1;
+
+        y = std::abs(spread) < illConditionedTolerance
+              ? curve.evaluate(0.5 * (xBar + state.x1))
+              : (2.0 / spread) * (curve.antiderivative1(xBar) + (state.ad2 - curve.antiderivative2(xBar)) / spread);
+    }
+    else
+    {
+        y = 2.0 * (d0 - state.d1) / (x - state.x2);
+    }
+
+    state.d1 = d0;
+    state.x2 = state.x1;
+    state.x1 = x;
+    state.ad2 = ad2;
+    return y;
+}
+
+void AdaaShaper::process(int channel, float* const* bands, const float* input, int numSamples,
+                         float drive, const float* driveRamp, Order order) noexcept
+{
+    if (driveRamp != nullptr)
+        processChannel<true>(channel, bands, input, numSamples, drive, driveRamp, order);
+    else
+        processChannel<false>(channel, bands, input, numSamples, drive, nullptr, order);
+}
+
+template <bool Ramped>
+void AdaaShaper::processChannel(int channel, float* const* bands, const float* input, int numSamples,
+                                float drive, const float* driveRamp, Order order) noexcept
+{
+    jassert(juce::isPositiveAndBelow(channel, (int)states.size()));
+
+    auto& channelStates = states[(size_t)channel];
+    auto processBand = order == Order::first ? &AdaaShaper::processFirstOrder : &AdaaShaper::processSecondOrder;
+    const int numBands = layout.numBands;
+    float shaped[MultibandShaper::maxBands];
+    drive *= 6.2f;
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        if constexpr (Ramped)
+            drive = driveRamp[sample] * 6.2f;
+
+        // Adaptive Gain Compensation for Sustain
+        float inputGainComp = 1.0f + (0.22f / (0.12f + std::abs(input[sample])));
+        float adaptiveDrive = drive * inputGainComp;
+        float weightedSum = 0.0f;
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            const auto index = (size_t)band;
+            shaped[band] = (float)processBand(curves[index], channelStates[index], bands[band][sample] * (1.0f + adaptiveDrive * layout.drive[index]));
+            weightedSum += shaped[band] * layout.weight[index];
+        }
+
+        // Dynamic Control
+        float dynamicSmoothing = 1.0f / (1.0f + std::abs(weightedSum));
+
+        for (int band = 0; band < numBands; ++band)
+            bands[band][sample] = shaped[band] * dynamicSmoothing * layout.makeup[(size_t)band];
+    }
+}
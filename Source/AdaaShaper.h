@@ -0,0 +1,78 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "MultibandShaper.h"
+
+//==============================================================================
+/**
+    Antiderivative anti-aliased (ADAA) version of the band shapers.
+
+    Each band curve (hard clip followed by a signed power) is replaced by the
+    difference quotient of its first (1st order) or second (2nd order)
+    antiderivative. Both are known in closed form, so this suppresses aliasing
+    without raising the sample rate. The price is half a sample (1st order) or
+    one sample (2nd order) of delay and a couple of pow calls per band sample.
+
+    When consecutive inputs are nearly equal the quotient is ill-conditioned;
+    those samples fall back to evaluating the curve (or its antiderivative) at
+    the midpoint instead. Differences are taken in double precision.
+*/
+class AdaaShaper
+{
+public:
+    enum class Order
+    {
+        first = 1,
+        second = 2
+    };
+
+    AdaaShaper();
+
+    /** Allocates the per-channel state. */
+    void prepare(int numChannels);
+    void reset() noexcept;
+
+    /** Switches to the curves and band constants of a layout. Only recomputes the curves
+        that changed. Safe to call from the audio thread.
+    */
+    void setLayout(const MultibandShaper::Layout& newLayout) noexcept;
+
+    /** Shapes one channel of the layout's bands in place, like MultibandShaper::process(). */
+    void process(int channel, float* const* bands, const float* input, int numSamples,
+                 float drive, const float* driveRamp, Order order) noexcept;
+
+private:
+    struct Curve
+    {
+        Curve() noexcept : Curve({ 1.0f, 1.0f, 1.0f }) {}
+        explicit Curve(const ShaperCurve& curve) noexcept;
+
+        double evaluate(double x) const noexcept;
+        double antiderivative1(double x) const noexcept;
+        double antiderivative2(double x) const noexcept;
+
+        double clipLevel, exponent, outputScale;
+        double clipPower, clipIntegral1, clipIntegral2;
+    };
+
+    struct BandState
+    {
+        double x1 = 0.0, x2 = 0.0;   // Previous two inputs
+        double ad1 = 0.0, ad2 = 0.0; // Antiderivatives at x1
+        double d1 = 0.0;             // Last 2nd order difference quotient
+    };
+
+    template <bool Ramped>
+    void processChannel(int channel, float* const* bands, const float* input, int numSamples,
+                        float drive, const float* driveRamp, Order order) noexcept;
+
+    static double processFirstOrder(const Curve& curve, BandState& state, double x) noexcept;
+    static double processSecondOrder(const Curve& curve, BandState& state, double x) noexcept;
+
+    MultibandShaper::Layout layout;
+    WaveshaperTableSet::Curves shaperCurves {};
+    std::array<Curve, MultibandShaper::maxBands> curves;
+    std::vector<std::array<BandState, MultibandShaper::maxBands>> states;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AdaaShaper)
+};
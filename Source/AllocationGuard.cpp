@@ -0,0 +1,76 @@
+#include "AllocationGuard.h"
+
+#if DISTROAR_CHECK_AUDIO_THREAD_ALLOCATIONS
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    thread_local bool allocationCheckActive = false;
+
+    void reportAudioThreadAllocation() noexcept
+    {
+        if (allocationCheckActive)
+        {
+            // Logging the assertion may allocate, so switch the check off while it fires
+            allocationCheckActive = false;
+            jassertfalse; // The heap was used from inside processBlock
+            allocationCheckActive = true;
+        }
+    }
+
+    void* checkedAllocate(std::size_t size)
+    {
+        reportAudioThreadAllocation();
+
+        if (auto* ptr = std::malloc(size == 0 ? 1 : size))
+            return ptr;
+
+        throw std::bad_alloc();
+    }
+
+    void checkedFree(void* ptr) noexcept
+    {
+        if (ptr != nullptr)
+            reportAudioThreadAllocation();
+
+        std::free(ptr);
+    }
+}
+
+ScopedAudioThreadAllocationCheck::ScopedAudioThreadAllocationCheck() noexcept
+    : wasActive(allocationCheckActive)
+{
+    allocationCheckActive = true;
+}
+
+ScopedAudioThreadAllocationCheck::~ScopedAudioThreadAllocationCheck() noexcept
+{
+    allocationCheckActive = wasActive;
+}
+
+//==============================================================================
+void* operator new(std::size_t size) { return checkedAllocate(size); }
+void* operator new[](std::size_t size) { return checkedAllocate(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    reportAudioThreadAllocation();
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    reportAudioThreadAllocation();
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void* ptr) noexcept { checkedFree(ptr); }
+void operator delete[](void* ptr) noexcept { checkedFree(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { checkedFree(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { checkedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { checkedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { checkedFree(ptr); }
+
+#endif
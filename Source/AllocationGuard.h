@@ -0,0 +1,34 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Set this to 1 (e.g. in the Projucer's preprocessor definitions for a Debug build) to
+// replace the global operator new/delete with versions that assert when they are called
+// while a ScopedAudioThreadAllocationCheck is alive on the calling thread.
+#ifndef DISTROAR_CHECK_AUDIO_THREAD_ALLOCATIONS
+ #define DISTROAR_CHECK_AUDIO_THREAD_ALLOCATIONS 0
+#endif
+
+//==============================================================================
+/**
+    Marks the current thread as being inside processBlock for the lifetime of this object.
+
+    When DISTROAR_CHECK_AUDIO_THREAD_ALLOCATIONS is enabled, any operator new or delete
+    on that thread hits a jassert. Memory obtained straight from malloc (e.g. HeapBlock)
+    is not hooked. When the check is disabled this compiles to nothing.
+*/
+class ScopedAudioThreadAllocationCheck
+{
+public:
+#if DISTROAR_CHECK_AUDIO_THREAD_ALLOCATIONS
+    ScopedAudioThreadAllocationCheck() noexcept;
+    ~ScopedAudioThreadAllocationCheck() noexcept;
+
+private:
+    bool wasActive;
+#else
+    ScopedAudioThreadAllocationCheck() noexcept {}
+#endif
+
+    JUCE_DECLARE_NON_COPYABLE(ScopedAudioThreadAllocationCheck)
+};
@@ -0,0 +1,35 @@
+#include "CabSimulator.h"
+
+template <typename SampleType>
+void CabSimulator<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    // Keep the low pass below Nyquist at low host sample rates
+    const auto lowPassCutoff = (SampleType)juce::jmin(lowPassFrequency, (float)spec.sampleRate * 0.45f);
+
+    auto highPassCoefficients = juce::dsp::IIR::Coefficients<SampleType>::makeHighPass(spec.sampleRate, (SampleType)highPassFrequency);
+    auto lowPassCoefficients = juce::dsp::IIR::Coefficients<SampleType>::makeLowPass(spec.sampleRate, lowPassCutoff);
+
+    highPassFilters.clear();
+    lowPassFilters.clear();
+
+    for (juce::uint32 channel = 0; channel < spec.numChannels; ++channel)
+    {
+        highPassFilters.add(new Filter(highPassCoefficients))->prepare(spec);
+        lowPassFilters.add(new Filter(lowPassCoefficients))->prepare(spec);
+    }
+
+    reset();
+}
+
+template <typename SampleType>
+void CabSimulator<SampleType>::reset()
+{
+    for (auto* filter : highPassFilters)
+        filter->reset();
+
+    for (auto* filter : lowPassFilters)
+        filter->reset();
+}
+
+template class CabSimulator<float>;
+template class CabSimulator<double>;
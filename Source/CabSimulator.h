@@ -0,0 +1,38 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Cabinet voicing stage: a high pass to cut sub-bass and a low pass to tame fizz.
+
+    Coefficients are designed once in prepare() for the host sample rate, so
+    processing is just two biquads per sample and channel. Each channel has its
+    own pair of filters sharing those coefficients, so the stage runs one sample
+    at a time inside the chain's per-sample loop.
+*/
+template <typename SampleType>
+class CabSimulator
+{
+public:
+    CabSimulator() = default;
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset();
+
+    SampleType processSample(int channel, SampleType input) noexcept
+    {
+        return lowPassFilters.getUnchecked(channel)->processSample(highPassFilters.getUnchecked(channel)->processSample(input));
+    }
+
+    static constexpr float highPassFrequency = 95.0f; // Cut sub-bass
+    static constexpr float lowPassFrequency = 6500.0f; // Remove fizz
+
+private:
+    using Filter = juce::dsp::IIR::Filter<SampleType>;
+
+    juce::OwnedArray<Filter> highPassFilters;
+    juce::OwnedArray<Filter> lowPassFilters;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CabSimulator)
+};
@@ -0,0 +1,271 @@
+#include "CabinetImpulseResponse.h"
+
+CabinetImpulseResponse::CabinetImpulseResponse()
+{
+    formatManager.registerBasicFormats();
+    backgroundThread->addTimeSliceClient(this);
+}
+
+CabinetImpulseResponse::~CabinetImpulseResponse()
+{
+    backgroundThread->removeTimeSliceClient(this);
+    delete pendingConvolution.exchange(nullptr);
+    delete retiredConvolution.exchange(nullptr);
+}
+
+void CabinetImpulseResponse::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    const int numChannels = (int)spec.numChannels;
+    crossfadeSamples = juce::jmax(1, juce::roundToInt(crossfadeSeconds * spec.sampleRate));
+    bool loadNow;
+
+    {
+        const juce::ScopedLock sl(requestLock);
+
+        // A response built for another rate or channel count is of no use any more
+        if (spec.sampleRate != requestedSampleRate || numChannels != requestedNumChannels)
+        {
+            requestedSampleRate = spec.sampleRate;
+            requestedNumChannels = numChannels;
+            ++requestId;
+            loadRequested = requestedSettings.file != juce::File();
+            loadedLengthSamples = 0;
+
+            convolution.reset();
+            fadingConvolution.reset();
+            delete pendingConvolution.exchange(nullptr);
+        }
+
+        loadNow = nonRealtime && loadRequested;
+    }
+
+    if (loadNow)
+        loadRequestedResponse();
+
+    reset();
+}
+
+void CabinetImpulseResponse::reset() noexcept
+{
+    if (convolution != nullptr)
+        convolution->reset();
+
+    // A crossfade in progress is dropped along with the rest of the history
+    convolutionHeard = false;
+    crossfadeRemaining = 0;
+}
+
+void CabinetImpulseResponse::load(const Settings& newSettings)
+{
+    auto settings = newSettings;
+    settings.lengthLimitSeconds = juce::jlimit(minLengthLimitSeconds, maxLengthLimitSeconds, newSettings.lengthLimitSeconds);
+
+    {
+        const juce::ScopedLock sl(requestLock);
+
+        if (settings == requestedSettings)
+            return;
+
+        requestedSettings = settings;
+        ++requestId;
+        loadRequested = true;
+    }
+
+    // Offline the response is in place before the next block, whatever the timing
+    if (nonRealtime)
+        loadRequestedResponse();
+}
+
+void CabinetImpulseResponse::setNonRealtime(bool isNonRealtime)
+{
+    {
+        const juce::ScopedLock sl(requestLock);
+
+        if (isNonRealtime == nonRealtime)
+            return;
+
+        // The current response keeps playing until it is rebuilt with or without a worker
+        nonRealtime = isNonRealtime;
+        ++requestId;
+        loadRequested = requestedSettings.file != juce::File();
+    }
+
+    // Waits for a load the background thread may have in progress, which is then dropped as overtaken
+    if (isNonRealtime)
+        loadRequestedResponse();
+}
+
+void CabinetImpulseResponse::process(float* const* channels, float* const* fadeScratch, int numSamples) noexcept
+{
+    if (fadingConvolution == nullptr)
+    {
+        if (auto* next = pendingConvolution.exchange(nullptr))
+        {
+            fadingConvolution = std::move(convolution);
+            convolution.reset(next);
+            crossfadeRemaining = fadingConvolution != nullptr && convolutionHeard ? crossfadeSamples : 0;
+            convolutionHeard = false;
+        }
+    }
+
+    if (fadingConvolution != nullptr && crossfadeRemaining == 0)
+        retire(fadingConvolution);
+
+    if (convolution == nullptr)
+        return;
+
+    const int numChannels = convolution->getNumChannels();
+    float* const* previous = fadeScratch;
+
+    if (crossfadeRemaining > 0)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            std::copy(channels[channel], channels[channel] + numSamples, previous[channel]);
+
+        fadingConvolution->process(previous, numSamples);
+    }
+
+    convolution->process(channels, numSamples);
+    convolutionHeard = true;
+
+    if (crossfadeRemaining > 0)
+    {
+        const int numFading = juce::jmin(numSamples, crossfadeRemaining);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            for (int i = 0; i < numFading; ++i)
+            {
+                const float gain = (float)(crossfadeRemaining - i) / (float)crossfadeSamples;
+                channels[channel][i] += gain * (previous[channel][i] - channels[channel][i]);
+            }
+        }
+
+        crossfadeRemaining -= numFading;
+    }
+}
+
+void CabinetImpulseResponse::retire(std::unique_ptr<PartitionedConvolution>& finished) noexcept
+{
+    // Destroying a convolution stops its worker, which is left to the background thread.
+    // If the previous one has not been collected yet, this is tried again next block.
+    PartitionedConvolution* empty = nullptr;
+
+    if (retiredConvolution.compare_exchange_strong(empty, finished.get()))
+        finished.release();
+}
+
+int CabinetImpulseResponse::useTimeSlice()
+{
+    delete retiredConvolution.exchange(nullptr);
+
+    {
+        const juce::ScopedLock sl(requestLock);
+
+        // Nothing can be resampled before the first prepare(), and offline every load is synchronous
+        if (nonRealtime || !loadRequested || requestedSampleRate <= 0.0)
+            return 50;
+    }
+
+    loadRequestedResponse();
+    return 0;
+}
+
+void CabinetImpulseResponse::loadRequestedResponse()
+{
+    const juce::ScopedLock loading(loadLock);
+
+    Settings settings;
+    double sampleRate;
+    int numChannels, id;
+    bool useWorker;
+
+    {
+        const juce::ScopedLock sl(requestLock);
+
+        if (!loadRequested || requestedSampleRate <= 0.0)
+            return;
+
+        loadRequested = false;
+        settings = requestedSettings;
+        sampleRate = requestedSampleRate;
+        numChannels = requestedNumChannels;
+        useWorker = !nonRealtime;
+        id = requestId;
+    }
+
+    const auto impulseResponse = readImpulseResponse(settings, sampleRate);
+    std::unique_ptr<PartitionedConvolution> next;
+
+    if (impulseResponse.getNumSamples() > 0)
+        next = std::make_unique<PartitionedConvolution>(impulseResponse, numChannels, useWorker);
+
+    const juce::ScopedLock sl(requestLock);
+
+    // Overtaken by a newer request, which is loaded next
+    if (id != requestId)
+        return;
+
+    if (next != nullptr)
+        delete pendingConvolution.exchange(next.release());
+
+    loadedLengthSamples = impulseResponse.getNumSamples();
+}
+
+juce::AudioBuffer<float> CabinetImpulseResponse::readImpulseResponse(const Settings& settings, double targetSampleRate)
+{
+    if (settings.file == juce::File())
+        return {};
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(settings.file));
+
+    if (reader == nullptr || reader->lengthInSamples <= 0 || reader->sampleRate <= 0.0)
+        return {};
+
+    // Only the first two channels are used, one per output channel
+    const int numChannels = juce::jlimit(1, 2, (int)reader->numChannels);
+    const auto lengthLimit = (juce::int64)std::ceil(settings.lengthLimitSeconds * reader->sampleRate);
+    const int length = (int)juce::jmin(reader->lengthInSamples, lengthLimit);
+
+    juce::AudioBuffer<float> impulseResponse(numChannels, length);
+    reader->read(&impulseResponse, 0, length, 0, true, numChannels > 1);
+
+    // A response that was cut ends in a short fade instead of a step
+    if (length < reader->lengthInSamples)
+    {
+        const int fadeLength = juce::jmin(length, (int)std::ceil(fadeOutSeconds * reader->sampleRate));
+        impulseResponse.applyGainRamp(length - fadeLength, fadeLength, 1.0f, 0.0f);
+    }
+
+    if (reader->sampleRate != targetSampleRate)
+    {
+        juce::MemoryAudioSource source(impulseResponse, false);
+        juce::ResamplingAudioSource resampler(&source, false, numChannels);
+        resampler.setResamplingRatio(reader->sampleRate / targetSampleRate);
+        resampler.prepareToPlay(length, targetSampleRate);
+
+        juce::AudioBuffer<float> resampled(numChannels, (int)std::ceil(length * targetSampleRate / reader->sampleRate));
+        resampler.getNextAudioBlock(juce::AudioSourceChannelInfo(resampled));
+        impulseResponse = std::move(resampled);
+    }
+
+    // Unit energy on the louder channel, so broadband material keeps roughly its level
+    float energy = 0.0f;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* data = impulseResponse.getReadPointer(channel);
+        float channelEnergy = 0.0f;
+
+        for (int i = 0; i < impulseResponse.getNumSamples(); ++i)
+            channelEnergy += data[i] * data[i];
+
+        energy = juce::jmax(energy, channelEnergy);
+    }
+
+    if (energy <= 0.0f)
+        return {};
+
+    impulseResponse.applyGain(1.0f / std::sqrt(energy));
+    return impulseResponse;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SharedBackgroundThread.h"
+#include "PartitionedConvolution.h"
+
+//==============================================================================
+/**
+    Impulse response cabinet stage on a PartitionedConvolution.
+
+    The convolution has no latency, and the audio thread's share of its work does
+    not grow with the response length. Files are read, cut to the length limit,
+    resampled to the prepared rate and normalised on the shared background thread,
+    which also builds the convolution. The audio thread picks it up at the start of
+    a block and crossfades from the previous response, so swapping never clicks.
+
+    In non-realtime mode the convolution computes its tail inline, and responses are
+    loaded synchronously by load(), prepare() and setNonRealtime(), so offline renders
+    are deterministic and start with the response in place.
+*/
+class CabinetImpulseResponse : private juce::TimeSliceClient
+{
+public:
+    static constexpr double minLengthLimitSeconds = 0.01, maxLengthLimitSeconds = 3.0;
+
+    struct Settings
+    {
+        juce::File file;                    // No file means no impulse response
+        double lengthLimitSeconds = 0.5;    // Longer responses are cut, trading realism for CPU
+
+        bool operator==(const Settings& other) const noexcept
+        {
+            return file == other.file && lengthLimitSeconds == other.lengthLimitSeconds;
+        }
+
+        bool operator!=(const Settings& other) const noexcept { return !operator==(other); }
+    };
+
+    CabinetImpulseResponse();
+    ~CabinetImpulseResponse() override;
+
+    /** Prepares for a sample rate and channel count. A response loaded for another configuration
+        is loaded again; in non-realtime mode before this returns.
+    */
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset() noexcept;
+
+    /** Requests a new impulse response, or none for an empty file. In non-realtime mode it is
+        loaded before this returns. Call from any thread except the audio thread.
+    */
+    void load(const Settings& newSettings);
+
+    /** Switches between realtime and offline processing, see the class description. Switching to
+        offline loads the response again before this returns. Not for the audio thread.
+    */
+    void setNonRealtime(bool isNonRealtime);
+
+    /** True once a response has been loaded, until it is cleared. */
+    bool isLoaded() const noexcept { return loadedLengthSamples.load() > 0; }
+
+    /** Length of the current response in samples at the prepared rate, 0 if there is none. */
+    int getLengthSamples() const noexcept { return loadedLengthSamples.load(); }
+
+    /** Convolves numSamples samples of the prepared channels in place. fadeScratch holds as many
+        channels of at least numSamples samples, for the previous response while crossfading.
+    */
+    void process(float* const* channels, float* const* fadeScratch, int numSamples) noexcept;
+
+private:
+    static constexpr double fadeOutSeconds = 0.005;     // Applied where a response is cut
+    static constexpr double crossfadeSeconds = 0.05;    // Between the previous response and a new one
+
+    int useTimeSlice() override;
+    void loadRequestedResponse();
+    juce::AudioBuffer<float> readImpulseResponse(const Settings& settings, double targetSampleRate);
+    void retire(std::unique_ptr<PartitionedConvolution>& finished) noexcept;
+
+    juce::AudioFormatManager formatManager;     // Whoever loads
+
+    juce::CriticalSection requestLock;
+    Settings requestedSettings;
+    double requestedSampleRate = 0.0;
+    int requestedNumChannels = 0;
+    std::atomic<bool> nonRealtime { false };
+    bool loadRequested = false;
+    int requestId = 0;                          // Counts requests, so a load that was overtaken is dropped
+    juce::CriticalSection loadLock;             // Held for a whole load
+    std::atomic<int> loadedLengthSamples { 0 };
+
+    // Handed from the loader to the audio thread, and back once finished with. Whoever
+    // takes a pointer out of either slot owns it.
+    std::atomic<PartitionedConvolution*> pendingConvolution { nullptr };
+    std::atomic<PartitionedConvolution*> retiredConvolution { nullptr };
+
+    // Audio thread
+    std::unique_ptr<PartitionedConvolution> convolution;
+    std::unique_ptr<PartitionedConvolution> fadingConvolution;  // The previous response while crossfading
+    bool convolutionHeard = false;              // Whether the current response was used since its last reset
+    int crossfadeSamples = 0;
+    int crossfadeRemaining = 0;
+
+    juce::SharedResourcePointer<SharedBackgroundThread> backgroundThread;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CabinetImpulseResponse)
+};
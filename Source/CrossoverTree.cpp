@@ -0,0 +1,75 @@
+#include "CrossoverTree.h"
+
+template <typename SampleType>
+CrossoverTree<SampleType>::CrossoverTree()
+{
+    for (auto& filter : lowPasses)
+        filter.setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
+
+    highPass.setType(juce::dsp::LinkwitzRileyFilterType::highpass);
+}
+
+template <typename SampleType>
+void CrossoverTree<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    for (auto& filter : lowPasses)
+        filter.prepare(spec);
+
+    highPass.prepare(spec);
+}
+
+template <typename SampleType>
+void CrossoverTree<SampleType>::reset() noexcept
+{
+    for (auto& filter : lowPasses)
+        filter.reset();
+
+    highPass.reset();
+}
+
+template <typename SampleType>
+void CrossoverTree<SampleType>::setNumBands(int newNumBands) noexcept
+{
+    numBands = juce::jlimit(MultibandShaper::minBands, maxBands, newNumBands);
+    reset();
+}
+
+template <typename SampleType>
+void CrossoverTree<SampleType>::setSplitFrequencies(const float* frequencies) noexcept
+{
+    for (int band = 0; band < numBands - 2; ++band)
+        lowPasses[(size_t)band].setCutoffFrequency((SampleType)frequencies[band]);
+
+    highPass.setCutoffFrequency((SampleType)frequencies[numBands - 2]);
+}
+
+template <typename SampleType>
+void CrossoverTree<SampleType>::glideSplitFrequencies(const float* frequencies, int numSamples) noexcept
+{
+    for (int band = 0; band < numBands - 2; ++band)
+        lowPasses[(size_t)band].glideCutoffFrequency((SampleType)frequencies[band], numSamples);
+
+    highPass.glideCutoffFrequency((SampleType)frequencies[numBands - 2], numSamples);
+}
+
+template <typename SampleType>
+void CrossoverTree<SampleType>::getSplitFrequencies(float lowest, float highest, int numBands, float* frequencies) noexcept
+{
+    jassert(numBands >= MultibandShaper::minBands && numBands <= maxBands);
+
+    if (numBands == 2)
+    {
+        frequencies[0] = std::sqrt(lowest * highest);
+        return;
+    }
+
+    const float ratio = highest / lowest;
+
+    for (int split = 0; split < numBands - 1; ++split)
+        frequencies[split] = split == 0 ? lowest
+                           : split == numBands - 2 ? highest
+                           : lowest * std::pow(ratio, (float)split / (float)(numBands - 2));
+}
+
+template class CrossoverTree<float>;
+template class CrossoverTree<double>;
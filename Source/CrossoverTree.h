@@ -0,0 +1,77 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "MultibandShaper.h"
+#include "SmoothedLinkwitzRiley.h"
+
+//==============================================================================
+/**
+    Splits a signal into 2 to 6 bands with Linkwitz-Riley filters.
+
+    The top band is a high pass at the highest split. Every band below the
+    second highest is the difference of two neighbouring low passes, and the
+    second highest band takes whatever is left, so the bands always sum back to
+    the input. With three bands this is the original low / mid / high split.
+
+    All cutoffs can glide, see SmoothedLinkwitzRiley.
+*/
+template <typename SampleType>
+class CrossoverTree
+{
+public:
+    static constexpr int maxBands = MultibandShaper::maxBands;
+
+    CrossoverTree();
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset() noexcept;
+
+    /** Changes the number of bands and resets the filters. */
+    void setNumBands(int newNumBands) noexcept;
+    int getNumBands() const noexcept { return numBands; }
+
+    /** Jumps to new split frequencies, getNumBands() - 1 of them in ascending order. */
+    void setSplitFrequencies(const float* frequencies) noexcept;
+
+    /** Glides to new split frequencies over the next numSamples calls to advance(). */
+    void glideSplitFrequencies(const float* frequencies, int numSamples) noexcept;
+
+    /** The numBands - 1 split frequencies for a band count, spaced evenly in pitch from lowest to
+        highest. Two bands split halfway between them.
+    */
+    static void getSplitFrequencies(float lowest, float highest, int numBands, float* frequencies) noexcept;
+
+    /** Splits one sample of one channel into getNumBands() bands. Call advance() once every channel of the sample is done. */
+    void processSample(int channel, SampleType input, SampleType* bands) noexcept
+    {
+        const int lastBand = numBands - 1;
+        const SampleType highBand = highPass.processSample(channel, input);
+        SampleType below = 0;
+
+        for (int band = 0; band < lastBand - 1; ++band)
+        {
+            const SampleType lowBand = lowPasses[(size_t)band].processSample(channel, input);
+            bands[band] = lowBand - below;
+            below = lowBand;
+        }
+
+        bands[lastBand - 1] = input - below - highBand;
+        bands[lastBand] = highBand;
+    }
+
+    /** Steps the glides on by one sample. */
+    void advance() noexcept
+    {
+        for (int band = 0; band < numBands - 2; ++band)
+            lowPasses[(size_t)band].advance();
+
+        highPass.advance();
+    }
+
+private:
+    std::array<SmoothedLinkwitzRiley<SampleType>, maxBands - 2> lowPasses;
+    SmoothedLinkwitzRiley<SampleType> highPass;
+    int numBands = 3;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CrossoverTree)
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Multichannel delay with a delay time fixed per block, used to keep an
+    unprocessed copy of the input in line with the processed, latent one.
+
+    Memory is allocated in prepare(). Processing is a couple of block copies per
+    channel, there is no per-sample work.
+*/
+template <typename SampleType>
+class DelayBuffer
+{
+public:
+    DelayBuffer() = default;
+
+    /** Allocates room for delays of up to maxDelaySamples on blocks of up to maxBlockSize. */
+    void prepare(int numChannels, int maxDelaySamples, int maxBlockSize)
+    {
+        bufferSize = maxDelaySamples + maxBlockSize;
+        buffer.setSize(numChannels, bufferSize);
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        buffer.clear();
+        writePosition = 0;
+    }
+
+    /** Writes numSamples of input and reads the same number, delaySamples older, into output. */
+    void process(const SampleType* const* input, SampleType* const* output, int numSamples, int delaySamples) noexcept
+    {
+        jassert(delaySamples >= 0 && delaySamples + numSamples <= bufferSize);
+
+        const int readPosition = (writePosition - delaySamples + bufferSize) % bufferSize;
+
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            copyIn(buffer.getWritePointer(channel), input[channel], numSamples);
+            copyOut(output[channel], buffer.getReadPointer(channel), readPosition, numSamples);
+        }
+
+        writePosition = (writePosition + numSamples) % bufferSize;
+    }
+
+private:
+    void copyIn(SampleType* ring, const SampleType* source, int numSamples) const noexcept
+    {
+        const int firstPart = juce::jmin(numSamples, bufferSize - writePosition);
+        juce::FloatVectorOperations::copy(ring + writePosition, source, firstPart);
+        juce::FloatVectorOperations::copy(ring, source + firstPart, numSamples - firstPart);
+    }
+
+    void copyOut(SampleType* destination, const SampleType* ring, int readPosition, int numSamples) const noexcept
+    {
+        const int firstPart = juce::jmin(numSamples, bufferSize - readPosition);
+        juce::FloatVectorOperations::copy(destination, ring + readPosition, firstPart);
+        juce::FloatVectorOperations::copy(destination + firstPart, ring, numSamples - firstPart);
+    }
+
+    juce::AudioBuffer<SampleType> buffer;
+    int bufferSize = 0;
+    int writePosition = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DelayBuffer)
+};
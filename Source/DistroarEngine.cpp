@@ -0,0 +1,107 @@
+#include "DistroarEngine.h"
+
+void DistroarEngine::prepare(double newSampleRate, int maxBlockSize, int newNumChannels, Precision newPrecision)
+{
+    sampleRate = newSampleRate;
+    numChannels = newNumChannels;
+    precision = newPrecision;
+
+    // The chain is specialised for mono or stereo, anything wider only has its first two channels processed
+    jassert(numChannels <= ProcessingChain<float>::maxChannels);
+    const int chainChannels = juce::jlimit(1, ProcessingChain<float>::maxChannels, numChannels);
+
+    // Only keep the chain for the requested precision and channel count around
+    if (precision == Precision::double_)
+    {
+        floatChain.reset();
+
+        if (doubleChain == nullptr || doubleChain->getNumChannels() != chainChannels)
+            doubleChain = ProcessingChain<double>::create(chainChannels);
+
+        doubleChain->setNonRealtime(nonRealtime);
+        doubleChain->loadImpulseResponse(impulseResponse);
+        doubleChain->prepare(sampleRate, maxBlockSize, parameters);
+    }
+    else
+    {
+        doubleChain.reset();
+
+        if (floatChain == nullptr || floatChain->getNumChannels() != chainChannels)
+            floatChain = ProcessingChain<float>::create(chainChannels);
+
+        floatChain->setNonRealtime(nonRealtime);
+        floatChain->loadImpulseResponse(impulseResponse);
+        floatChain->prepare(sampleRate, maxBlockSize, parameters);
+    }
+}
+
+void DistroarEngine::release()
+{
+    if (floatChain != nullptr)
+        floatChain->release();
+
+    if (doubleChain != nullptr)
+        doubleChain->release();
+}
+
+void DistroarEngine::setParameters(const Parameters& newParameters) noexcept
+{
+    parameters = newParameters;
+
+    if (floatChain != nullptr)
+        floatChain->setParameters(parameters);
+
+    if (doubleChain != nullptr)
+        doubleChain->setParameters(parameters);
+}
+
+void DistroarEngine::setImpulseResponse(const CabinetImpulseResponse::Settings& newImpulseResponse)
+{
+    impulseResponse = newImpulseResponse;
+
+    if (floatChain != nullptr)
+        floatChain->loadImpulseResponse(impulseResponse);
+
+    if (doubleChain != nullptr)
+        doubleChain->loadImpulseResponse(impulseResponse);
+}
+
+void DistroarEngine::setNonRealtime(bool isNonRealtime)
+{
+    nonRealtime = isNonRealtime;
+
+    if (floatChain != nullptr)
+        floatChain->setNonRealtime(nonRealtime);
+
+    if (doubleChain != nullptr)
+        doubleChain->setNonRealtime(nonRealtime);
+}
+
+double DistroarEngine::getTailLengthSeconds() const noexcept
+{
+    const double impulseResponseSeconds = impulseResponse.file != juce::File() ? impulseResponse.lengthLimitSeconds : 0.0;
+    return ProcessingChain<float>::getTailLengthSeconds() + impulseResponseSeconds;
+}
+
+bool DistroarEngine::process(float* const* channels, int numSamples) noexcept
+{
+    jassert(floatChain != nullptr); // Not prepared, or prepared for double precision
+    return floatChain != nullptr && numChannels > 0 && floatChain->process(channels, numSamples);
+}
+
+bool DistroarEngine::process(double* const* channels, int numSamples) noexcept
+{
+    jassert(doubleChain != nullptr); // Not prepared, or prepared for single precision
+    return doubleChain != nullptr && numChannels > 0 && doubleChain->process(channels, numSamples);
+}
+
+int DistroarEngine::getLatencySamples() const noexcept
+{
+    if (floatChain != nullptr)
+        return floatChain->getLatencySamples();
+
+    if (doubleChain != nullptr)
+        return doubleChain->getLatencySamples();
+
+    return 0;
+}
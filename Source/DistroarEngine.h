@@ -0,0 +1,92 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ProcessingChain.h"
+
+//==============================================================================
+/**
+    The complete DISTROAR processing chain, independent of any plugin host.
+
+    prepare() allocates everything, process() never allocates or calls back into
+    a host, and parameters arrive as a plain struct. DISTROARAudioProcessor is a
+    thin wrapper around one of these; offline renderers can run as many copies
+    as they like.
+
+    The engine runs in single or double precision on one or two channels, chosen
+    in prepare(). Only the chain specialised for that combination is allocated.
+*/
+class DistroarEngine
+{
+public:
+    static constexpr int maxOversamplingStages = ProcessingChain<float>::maxOversamplingStages;
+
+    using Parameters = ChainParameters;
+
+    enum class Precision
+    {
+        single,
+        double_
+    };
+
+    DistroarEngine() = default;
+
+    /** Allocates everything needed to process up to maxBlockSize samples of numChannels channels.
+        Larger blocks are accepted by process() and handled in chunks.
+    */
+    void prepare(double sampleRate, int maxBlockSize, int numChannels, Precision precision = Precision::single);
+
+    /** Frees the memory allocated by prepare(). */
+    void release();
+
+    /** Takes new parameter values. Moving values are smoothed over the following blocks. */
+    void setParameters(const Parameters& newParameters) noexcept;
+    const Parameters& getParameters() const noexcept { return parameters; }
+
+    /** Sets the cabinet impulse response. It is loaded in the background and faded in once ready.
+        Not for the audio thread.
+    */
+    void setImpulseResponse(const CabinetImpulseResponse::Settings& newImpulseResponse);
+    const CabinetImpulseResponse::Settings& getImpulseResponse() const noexcept { return impulseResponse; }
+
+    /** In non-realtime mode the engine gives up background work for output that does not depend on
+        timing: an impulse response is in place as soon as it is set or prepare() returns, and its
+        whole convolution runs inside process(). Renderers should set this before prepare().
+        Not for the audio thread.
+    */
+    void setNonRealtime(bool isNonRealtime);
+    bool isNonRealtime() const noexcept { return nonRealtime; }
+
+    /** Processes numSamples samples of every prepared channel in place.
+        Use the overload matching the precision passed to prepare().
+
+        Returns true if the engine was idle: the input had been silent for long
+        enough that the output is silent too, and the block was simply cleared.
+    */
+    bool process(float* const* channels, int numSamples) noexcept;
+    bool process(double* const* channels, int numSamples) noexcept;
+
+    /** Latency of the current oversampling setting, in samples at the prepared rate. */
+    int getLatencySamples() const noexcept;
+
+    /** How long the output keeps ringing after the input goes silent, not counting latency.
+        Includes the longest impulse response the current settings allow.
+    */
+    double getTailLengthSeconds() const noexcept;
+
+    double getSampleRate() const noexcept { return sampleRate; }
+    int getNumChannels() const noexcept { return numChannels; }
+    Precision getPrecision() const noexcept { return precision; }
+
+private:
+    Parameters parameters;
+    CabinetImpulseResponse::Settings impulseResponse;
+    bool nonRealtime = false;
+    double sampleRate = 0.0;
+    int numChannels = 0;
+    Precision precision = Precision::single;
+
+    std::unique_ptr<ProcessingChain<float>> floatChain;
+    std::unique_ptr<ProcessingChain<double>> doubleChain;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DistroarEngine)
+};
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SimdFloat.h"
+
+//==============================================================================
+/**
+    Polynomial approximations of the transcendental functions used on the audio thread.
+
+    Every function is a template that works on a plain float or on a SimdFloat,
+    so the scalar and vector variants share one implementation. Max errors were
+    measured against libm in double precision over the stated input range, by
+    the fastMath section of the benchmark:
+
+        log2(x)             x in [0.5, 2]           abs error < 1.6e-7
+                            x in [1e-30, 1e30]      abs error < 4.0e-6 (result rounding)
+        exp2(x)             x in [-126, 126]        rel error < 2.5e-7
+        log(x)              x in [0.5, 2]           abs error < 1.2e-7
+        exp(x)              x in [-10, 10]          rel error < 7.0e-7
+                            x in [-87, 87]          rel error < 4.0e-6
+        pow(x, p)           x > 0, |p log2 x| < 45  rel error < 2.5e-6
+        signedPow(x, p)     |x| <= 1, p in [0.25, 4] rel error < 2.5e-6
+        tanh(x)             any x                   abs error < 1.6e-7
+        decibelsToGain(dB)  dB in [-100, 60]        rel error < 9.0e-7
+        gainToDecibels(g)   g in [1e-5, 1e3]        abs error < 1.1e-5 dB
+
+    Inputs outside a function's domain (log2 of a negative number, etc.) give
+    unspecified results instead of NaNs or exceptions.
+*/
+namespace FastMath
+{
+    //==============================================================================
+    /** Per-type primitives the templates below are written against. */
+    template <typename Type>
+    struct Ops;
+
+    template <>
+    struct Ops<float>
+    {
+        using Mask = bool;
+
+        static forcedinline float splat(float x) noexcept { return x; }
+        static forcedinline float mulAdd(float a, float b, float c) noexcept { return a * b + c; }
+        static forcedinline float abs(float x) noexcept { return std::abs(x); }
+        static forcedinline float sqrt(float x) noexcept { return std::sqrt(x); }
+        static forcedinline float max(float a, float b) noexcept { return juce::jmax(a, b); }
+        static forcedinline float clamp(float x, float lower, float upper) noexcept { return juce::jlimit(lower, upper, x); }
+        static forcedinline float copySign(float magnitude, float sign) noexcept { return std::copysign(magnitude, sign); }
+        static forcedinline bool lessThan(float a, float b) noexcept { return a < b; }
+        static forcedinline float select(bool mask, float a, float b) noexcept { return mask ? a : b; }
+        static forcedinline float round(float x) noexcept { return std::nearbyint(x); }
+
+        static forcedinline float powerOfTwo(float n) noexcept
+        {
+            const auto bits = ((int32_t)n + 127) << 23;
+            float result;
+            std::memcpy(&result, &bits, sizeof(result));
+            return result;
+        }
+
+        static forcedinline float splitExponent(float x, float& exponent) noexcept
+        {
+            int32_t bits;
+            std::memcpy(&bits, &x, sizeof(bits));
+            exponent = (float)((bits >> 23) - 127);
+            bits = (bits & 0x007fffff) | 0x3f800000;
+            float mantissa;
+            std::memcpy(&mantissa, &bits, sizeof(mantissa));
+            return mantissa;
+        }
+    };
+
+    template <>
+    struct Ops<SimdFloat>
+    {
+        using Mask = SimdFloat::Mask;
+
+        static forcedinline SimdFloat splat(float x) noexcept { return SimdFloat::broadcast(x); }
+        static forcedinline SimdFloat mulAdd(SimdFloat a, SimdFloat b, SimdFloat c) noexcept { return SimdFloat::mulAdd(a, b, c); }
+        static forcedinline SimdFloat abs(SimdFloat x) noexcept { return SimdFloat::abs(x); }
+        static forcedinline SimdFloat sqrt(SimdFloat x) noexcept { return SimdFloat::sqrt(x); }
+        static forcedinline SimdFloat max(SimdFloat a, SimdFloat b) noexcept { return SimdFloat::max(a, b); }
+        static forcedinline SimdFloat clamp(SimdFloat x, float lower, float upper) noexcept { return SimdFloat::clamp(x, lower, upper); }
+        static forcedinline SimdFloat copySign(SimdFloat magnitude, SimdFloat sign) noexcept { return SimdFloat::copySign(magnitude, sign); }
+        static forcedinline Mask lessThan(SimdFloat a, SimdFloat b) noexcept { return SimdFloat::lessThan(a, b); }
+        static forcedinline SimdFloat select(Mask mask, SimdFloat a, SimdFloat b) noexcept { return SimdFloat::select(mask, a, b); }
+        static forcedinline SimdFloat round(SimdFloat x) noexcept { return SimdFloat::round(x); }
+        static forcedinline SimdFloat powerOfTwo(SimdFloat n) noexcept { return SimdFloat::powerOfTwo(n); }
+        static forcedinline SimdFloat splitExponent(SimdFloat x, SimdFloat& exponent) noexcept { return SimdFloat::splitExponent(x, exponent); }
+    };
+
+    //==============================================================================
+    /** log2 of a positive normal number.
+        The mantissa is folded into [sqrt(0.5), sqrt(2)) and fed to an odd series
+        in t = (m - 1) / (m + 1).
+    */
+    template <typename Type>
+    forcedinline Type log2(Type x) noexcept
+    {
+        using O = Ops<Type>;
+
+        Type exponent;
+        auto mantissa = O::splitExponent(x, exponent);
+
+        const auto fold = O::lessThan(O::splat(1.41421356f), mantissa);
+        mantissa = O::select(fold, mantissa * O::splat(0.5f), mantissa);
+        exponent = O::select(fold, exponent + O::splat(1.0f), exponent);
+
+        const auto t = (mantissa - O::splat(1.0f)) / (mantissa + O::splat(1.0f));
+        const auto t2 = t * t;
+        auto series = O::mulAdd(t2, O::splat(0.41219858f), O::splat(0.57707801f));
+        series = O::mulAdd(t2, series, O::splat(0.96179669f));
+        series = O::mulAdd(t2, series, O::splat(2.88539008f));
+        return O::mulAdd(t, series, exponent);
+    }
+
+    /** 2^x, with x clamped to [-126, 126].
+        The integer part goes straight into the exponent bits, the fraction in
+        [-0.5, 0.5] through a degree 6 Taylor series.
+    */
+    template <typename Type>
+    forcedinline Type exp2(Type x) noexcept
+    {
+        using O = Ops<Type>;
+
+        x = O::clamp(x, -126.0f, 126.0f);
+        const auto whole = O::round(x);
+        const auto fraction = x - whole;
+
+        auto series = O::mulAdd(fraction, O::splat(1.5403530e-4f), O::splat(1.3333558e-3f));
+        series = O::mulAdd(fraction, series, O::splat(9.6181291e-3f));
+        series = O::mulAdd(fraction, series, O::splat(5.5504109e-2f));
+        series = O::mulAdd(fraction, series, O::splat(2.4022651e-1f));
+        series = O::mulAdd(fraction, series, O::splat(6.9314718e-1f));
+        series = O::mulAdd(fraction, series, O::splat(1.0f));
+        return series * O::powerOfTwo(whole);
+    }
+
+    template <typename Type>
+    forcedinline Type exp(Type x) noexcept
+    {
+        return exp2(x * Ops<Type>::splat(1.44269504f));
+    }
+
+    template <typename Type>
+    forcedinline Type log(Type x) noexcept
+    {
+        return log2(x) * Ops<Type>::splat(0.69314718f);
+    }
+
+    /** x^p for positive x. */
+    template <typename Type>
+    forcedinline Type pow(Type x, float p) noexcept
+    {
+        return exp2(log2(x) * Ops<Type>::splat(p));
+    }
+
+    //==============================================================================
+    /** sign(x) * |x|^exponent, zero for zero input. */
+    template <typename Type>
+    forcedinline Type signedPow(Type x, Type exponent) noexcept
+    {
+        using O = Ops<Type>;
+        const auto magnitude = O::abs(x);
+        const auto result = exp2(log2(magnitude) * exponent);
+        const auto isZero = O::lessThan(magnitude, O::splat(1.0e-30f));
+        return O::copySign(O::select(isZero, O::splat(0.0f), result), x);
+    }
+
+    /** Hyperbolic tangent as 1 - 2 / (e^2|x| + 1), saturating to +-1 beyond |x| = 10. */
+    template <typename Type>
+    forcedinline Type tanh(Type x) noexcept
+    {
+        using O = Ops<Type>;
+
+        const auto magnitude = O::clamp(O::abs(x), 0.0f, 10.0f);
+        const auto e = exp2(magnitude * O::splat(2.88539008f));
+        return O::copySign(O::splat(1.0f) - O::splat(2.0f) / (e + O::splat(1.0f)), x);
+    }
+
+    //==============================================================================
+    /** Same contract as juce::Decibels::decibelsToGain: anything at or below -100 dB is silence. */
+    template <typename Type>
+    forcedinline Type decibelsToGain(Type decibels) noexcept
+    {
+        using O = Ops<Type>;
+
+        const auto gain = exp2(decibels * O::splat(0.16609640f));
+        return O::select(O::lessThan(O::splat(-100.0f), decibels), gain, O::splat(0.0f));
+    }
+
+    /** Same contract as juce::Decibels::gainToDecibels: silence maps to -100 dB. */
+    template <typename Type>
+    forcedinline Type gainToDecibels(Type gain) noexcept
+    {
+        using O = Ops<Type>;
+
+        const auto decibels = log2(O::max(O::abs(gain), O::splat(1.0e-5f))) * O::splat(6.02059991f);
+        return O::max(decibels, O::splat(-100.0f));
+    }
+}
@@ -0,0 +1,269 @@
+#include "LinearPhaseCrossover.h"
+
+LinearPhaseCrossover::LinearPhaseCrossover()
+    : fft(fftOrder)
+{
+}
+
+int LinearPhaseCrossover::getKernelLength(double sampleRate) noexcept
+{
+    // Odd, so the kernel has a whole-sample centre and the dry path an integer delay
+    return 2 * juce::roundToInt(kernelSeconds * 0.5 * sampleRate) + 1;
+}
+
+int LinearPhaseCrossover::getLatencySamples(double sampleRate) noexcept
+{
+    return partitionSize + getKernelLength(sampleRate) / 2;
+}
+
+void LinearPhaseCrossover::prepare(double newSampleRate, int newNumChannels, const float* splitFrequencies, int newNumBands)
+{
+    sampleRate = newSampleRate;
+    numChannels = newNumChannels;
+
+    const int kernelLength = getKernelLength(sampleRate);
+    kernelDelay = kernelLength / 2;
+    numPartitions = (kernelLength + partitionSize - 1) / partitionSize;
+
+    fftBuffer.assign((size_t)(2 * fftSize), 0.0f);
+    accumulator.assign((size_t)numBins, {});
+
+    window.resize((size_t)kernelLength);
+    kernelScratch.resize((size_t)kernelLength);
+
+    for (int n = 0; n < kernelLength; ++n)
+    {
+        const double phase = juce::MathConstants<double>::twoPi * n / (kernelLength - 1);
+        window[(size_t)n] = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+    }
+
+    for (auto& kernel : kernels)
+        kernel.resize((size_t)(numPartitions * numBins));
+
+    // Design every kernel now, the unused ones for the top split, so adding bands later only redesigns what moved
+    setFrequencies(splitFrequencies, newNumBands);
+
+    for (size_t split = 0; split < kernels.size(); ++split)
+    {
+        designedFrequencies[split] = frequencies[split];
+        designKernel(kernels[split], frequencies[split]);
+    }
+
+    inputBlocks.setSize(numChannels, 2 * partitionSize);
+    inputSpectra.assign((size_t)(numChannels * numPartitions * numBins), {});
+    outputs.setSize(numChannels * numOutputs, partitionSize);
+
+    dryDelay.prepare(numChannels, kernelDelay, partitionSize);
+    dryBlock.setSize(numChannels, partitionSize);
+    partitionInputs.resize((size_t)numChannels);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        partitionInputs[(size_t)channel] = inputBlocks.getReadPointer(channel, partitionSize);
+
+    reset();
+}
+
+void LinearPhaseCrossover::reset() noexcept
+{
+    inputBlocks.clear();
+    outputs.clear();
+    std::fill(inputSpectra.begin(), inputSpectra.end(), Complex());
+    dryDelay.reset();
+    newestSpectrum = 0;
+    fillPosition = 0;
+}
+
+void LinearPhaseCrossover::setFrequencies(const float* splitFrequencies, int newNumBands) noexcept
+{
+    jassert(newNumBands >= 2 && newNumBands <= maxBands);
+    numBands = newNumBands;
+
+    for (int split = 0; split < maxBands - 1; ++split)
+        frequencies[(size_t)split] = splitFrequencies[juce::jmin(split, numBands - 2)];
+}
+
+void LinearPhaseCrossover::designKernel(std::vector<Complex>& spectra, float cutoff) noexcept
+{
+    // Blackman windowed sinc, normalised to unity gain at DC. The sines come from the
+    // recurrence sin((x + 1) w) = 2 cos(w) sin(x w) - sin((x - 1) w), so a redesign
+    // costs one sin and one cos rather than one per tap.
+    const double w = juce::MathConstants<double>::twoPi * cutoff / sampleRate;
+    const double twoCos = 2.0 * std::cos(w);
+    const int centre = kernelDelay;
+    double previousSine = 0.0;
+    double sine = std::sin(w);
+
+    kernelScratch[(size_t)centre] = w / juce::MathConstants<double>::pi * window[(size_t)centre];
+    double sum = kernelScratch[(size_t)centre];
+
+    for (int x = 1; x <= centre; ++x)
+    {
+        const double sinc = sine / (juce::MathConstants<double>::pi * x);
+        kernelScratch[(size_t)(centre + x)] = sinc * window[(size_t)(centre + x)];
+        kernelScratch[(size_t)(centre - x)] = sinc * window[(size_t)(centre - x)];
+        sum += 2.0 * kernelScratch[(size_t)(centre + x)];
+
+        const double nextSine = twoCos * sine - previousSine;
+        previousSine = sine;
+        sine = nextSine;
+    }
+
+    // One spectrum per partition, each partition zero padded to the FFT size
+    const int kernelLength = (int)kernelScratch.size();
+
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        std::fill(fftBuffer.begin(), fftBuffer.end(), 0.0f);
+
+        for (int i = 0; i < partitionSize; ++i)
+        {
+            const int index = partition * partitionSize + i;
+
+            if (index < kernelLength)
+                fftBuffer[(size_t)i] = (float)(kernelScratch[(size_t)index] / sum);
+        }
+
+        fft.performRealOnlyForwardTransform(fftBuffer.data(), true);
+
+        auto* bins = reinterpret_cast<const Complex*>(fftBuffer.data());
+        std::copy(bins, bins + numBins, spectra.begin() + partition * numBins);
+    }
+}
+
+template <typename SampleType>
+void LinearPhaseCrossover::process(const SampleType* const* input, SampleType* const* dry, SampleType* const* const* bands, int numSamples) noexcept
+{
+    const int numUsedOutputs = 1 + numBands;
+    SampleType* const* destinations[numOutputs] = { dry };
+
+    for (int band = 0; band < numBands; ++band)
+        destinations[1 + band] = bands[band];
+
+    // Input goes into the current partition while the previous partition's output is handed out
+    for (int done = 0; done < numSamples;)
+    {
+        const int numToCopy = juce::jmin(numSamples - done, partitionSize - fillPosition);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* block = inputBlocks.getWritePointer(channel, partitionSize + fillPosition);
+            const auto* source = input[channel] + done;
+
+            for (int i = 0; i < numToCopy; ++i)
+                block[i] = (float)source[i];
+
+            for (int output = 0; output < numUsedOutputs; ++output)
+            {
+                const auto* result = outputs.getReadPointer(channel * numOutputs + output, fillPosition);
+                auto* destination = destinations[output][channel] + done;
+
+                for (int i = 0; i < numToCopy; ++i)
+                    destination[i] = (SampleType)result[i];
+            }
+        }
+
+        fillPosition += numToCopy;
+        done += numToCopy;
+
+        if (fillPosition == partitionSize)
+        {
+            processPartition();
+            fillPosition = 0;
+        }
+    }
+}
+
+void LinearPhaseCrossover::processPartition() noexcept
+{
+    // Follow moved crossover points. Swapping kernels between partitions keeps the bands
+    // summing to the input, and smoothed frequencies only ever take small steps.
+    const int numSplits = numBands - 1;
+
+    for (int split = 0; split < numSplits; ++split)
+    {
+        if (frequencies[(size_t)split] != designedFrequencies[(size_t)split])
+        {
+            designKernel(kernels[(size_t)split], frequencies[(size_t)split]);
+            designedFrequencies[(size_t)split] = frequencies[(size_t)split];
+        }
+    }
+
+    // The top band is the delayed input minus a low pass, so delay the input like the kernels do
+    dryDelay.process(partitionInputs.data(), dryBlock.getArrayOfWritePointers(), partitionSize, kernelDelay);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* block = inputBlocks.getWritePointer(channel);
+
+        // Overlap-save: transform the last two partitions of input and keep the spectrum
+        std::copy(block, block + fftSize, fftBuffer.begin());
+        std::fill(fftBuffer.begin() + fftSize, fftBuffer.end(), 0.0f);
+        fft.performRealOnlyForwardTransform(fftBuffer.data(), true);
+
+        auto* spectra = inputSpectra.data() + channel * numPartitions * numBins;
+        auto* bins = reinterpret_cast<const Complex*>(fftBuffer.data());
+        std::copy(bins, bins + numBins, spectra + newestSpectrum * numBins);
+
+        // Each split's low pass goes into the output of the band below it first
+        float* data[numOutputs];
+
+        for (int output = 0; output <= numBands; ++output)
+            data[output] = outputs.getWritePointer(channel * numOutputs + output);
+
+        for (int split = 0; split < numSplits; ++split)
+            convolve(kernels[(size_t)split], spectra, data[1 + split]);
+
+        const auto* delayedInput = dryBlock.getReadPointer(channel);
+
+        for (int i = 0; i < partitionSize; ++i)
+        {
+            // Working down from the top, each band is what its upper edge passes minus its lower edge
+            float upper = delayedInput[i];
+            data[0][i] = upper;
+
+            for (int split = numSplits - 1; split >= 0; --split)
+            {
+                const float lowPass = data[1 + split][i];
+                data[2 + split][i] = upper - lowPass;
+                upper = lowPass;
+            }
+
+            data[1][i] = upper;
+        }
+
+        // Slide the input along by one partition
+        std::copy(block + partitionSize, block + fftSize, block);
+    }
+
+    newestSpectrum = (newestSpectrum + 1) % numPartitions;
+}
+
+void LinearPhaseCrossover::convolve(const std::vector<Complex>& kernel, const Complex* spectra, float* output) noexcept
+{
+    std::fill(accumulator.begin(), accumulator.end(), Complex());
+
+    for (int partition = 0; partition < numPartitions; ++partition)
+    {
+        const int slot = (newestSpectrum - partition + numPartitions) % numPartitions;
+        const auto* x = spectra + slot * numBins;
+        const auto* h = kernel.data() + partition * numBins;
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            // Written out, std::complex multiplication checks for infinities on every call
+            const float re = x[bin].real() * h[bin].real() - x[bin].imag() * h[bin].imag();
+            const float im = x[bin].real() * h[bin].imag() + x[bin].imag() * h[bin].real();
+            accumulator[(size_t)bin] += Complex(re, im);
+        }
+    }
+
+    std::fill(fftBuffer.begin(), fftBuffer.end(), 0.0f);
+    std::copy(accumulator.begin(), accumulator.end(), reinterpret_cast<Complex*>(fftBuffer.data()));
+    fft.performRealOnlyInverseTransform(fftBuffer.data());
+
+    // The second half is the part of the circular convolution that is free of wrap-around
+    std::copy(fftBuffer.begin() + partitionSize, fftBuffer.begin() + fftSize, output);
+}
+
+template void LinearPhaseCrossover::process<float>(const float* const*, float* const*, float* const* const*, int) noexcept;
+template void LinearPhaseCrossover::process<double>(const double* const*, double* const*, double* const* const*, int) noexcept;
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "DelayBuffer.h"
+
+//==============================================================================
+/**
+    Linear-phase alternative to the Linkwitz-Riley crossover.
+
+    There is one linear-phase low pass per split frequency. The lowest band is
+    the input through the lowest low pass, every band above it the difference
+    between two neighbouring low passes, and the top band the delayed input minus
+    the highest low pass. The bands add back up to the delayed input and every
+    band in between is properly band limited.
+
+    The low passes are windowed-sinc FIRs run by uniformly partitioned FFT
+    convolution, so the latency is one partition plus half the kernel length.
+    The convolution runs in float for either sample type.
+*/
+class LinearPhaseCrossover
+{
+public:
+    static constexpr int partitionSize = 256;
+    static constexpr double kernelSeconds = 0.04;   // Sets the transition width, about 140 Hz
+    static constexpr int maxBands = 6;
+
+    LinearPhaseCrossover();
+
+    /** Designs the kernels and allocates all state for up to maxBands bands. Call from prepare only. */
+    void prepare(double sampleRate, int numChannels, const float* splitFrequencies, int numBands);
+    void reset() noexcept;
+
+    /** Sets the band count and its numBands - 1 ascending split frequencies. The kernels are
+        redesigned, without allocating, at the start of the next partition, so frequency changes
+        should arrive smoothed. Changing the band count should be followed by reset().
+    */
+    void setFrequencies(const float* splitFrequencies, int newNumBands) noexcept;
+
+    /** Splits numSamples of input into the bands, plus the input delayed to match them.
+        bands holds one array of channel pointers per band.
+    */
+    template <typename SampleType>
+    void process(const SampleType* const* input, SampleType* const* dry, SampleType* const* const* bands, int numSamples) noexcept;
+
+    /** Latency in samples, the same for all bands and the dry output. */
+    int getLatencySamples() const noexcept { return partitionSize + kernelDelay; }
+
+    /** The latency a sample rate will have, without preparing. */
+    static int getLatencySamples(double sampleRate) noexcept;
+
+private:
+    using Complex = std::complex<float>;
+
+    static constexpr int fftOrder = 9;                  // Two partitions
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int numBins = fftSize / 2 + 1;
+
+    static int getKernelLength(double sampleRate) noexcept;
+
+    void designKernel(std::vector<Complex>& spectra, float cutoff) noexcept;
+    void processPartition() noexcept;
+    void convolve(const std::vector<Complex>& kernel, const Complex* spectra, float* output) noexcept;
+
+    // Per channel, the dry output followed by one output per band
+    static constexpr int numOutputs = 1 + maxBands;
+
+    juce::dsp::FFT fft;
+    double sampleRate = 0.0;
+    int numChannels = 0;
+    int numPartitions = 0;
+    int kernelDelay = 0;
+
+    std::array<std::vector<Complex>, maxBands - 1> kernels; // numPartitions spectra of each split's low pass
+    std::vector<double> window;         // Blackman window over the kernel length
+    std::vector<double> kernelScratch;
+    int numBands = 0;
+    std::array<float, maxBands - 1> frequencies {};         // Requested
+    std::array<float, maxBands - 1> designedFrequencies {}; // What the kernels are for
+
+    // Per channel: the last two partitions of input, a ring of past input spectra and
+    // the outputs of the previous partition, which are handed out while the next one fills
+    juce::AudioBuffer<float> inputBlocks;
+    std::vector<Complex> inputSpectra;
+    juce::AudioBuffer<float> outputs;   // numOutputs channels per input channel
+    int newestSpectrum = 0;
+    int fillPosition = 0;
+
+    DelayBuffer<float> dryDelay;
+    juce::AudioBuffer<float> dryBlock;
+    std::vector<const float*> partitionInputs;
+    std::vector<float> fftBuffer;
+    std::vector<Complex> accumulator;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LinearPhaseCrossover)
+};
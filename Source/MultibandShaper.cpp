@@ -0,0 +1,193 @@
+#include "MultibandShaper.h"
+#include "FastMath.h"
+
+namespace
+{
+    /** The fixed part of a band's sound, set by its position in the layout. */
+    struct Voicing
+    {
+        float outputScale;  // After the curve
+        float weight;       // Share in the dynamic control
+        float makeup;       // After the dynamic control
+    };
+
+    constexpr Voicing lowVoicing { 1.04f, 0.2f, 1.05f };
+    constexpr Voicing midVoicing { 1.18f, 0.28f, 1.08f };
+    constexpr Voicing highVoicing { 0.88f, 0.15f, 1.03f }; // Slight roll-off to control fizz
+}
+
+MultibandShaper::Layout MultibandShaper::makeLayout(int numBands, const BandShapes& shapes) noexcept
+{
+    Layout layout;
+    layout.numBands = juce::jlimit(minBands, maxBands, numBands);
+
+    for (int band = 0; band < layout.numBands; ++band)
+    {
+        const auto& voicing = band == 0 ? lowVoicing : (band == layout.numBands - 1 ? highVoicing : midVoicing);
+        const auto& shape = shapes[(size_t)band];
+
+        layout.drive[(size_t)band] = shape.drive;
+        layout.clipLevel[(size_t)band] = shape.clipLevel;
+        layout.exponent[(size_t)band] = shape.exponent;
+        layout.outputScale[(size_t)band] = voicing.outputScale;
+        layout.weight[(size_t)band] = voicing.weight;
+        layout.makeup[(size_t)band] = voicing.makeup;
+    }
+
+    return layout;
+}
+
+MultibandShaper::BandShapes MultibandShaper::getDefaultShapes() noexcept
+{
+    constexpr BandShape low { 0.4f, 0.32f, 0.65f };    // Clip reduces excess low-end
+    constexpr BandShape mid { 1.15f, 0.32f, 1.25f };
+    constexpr BandShape high { 0.3f, 0.18f, 1.2f };    // Lower drive and clip tame harsh high peaks
+
+    return { { low, mid, high, high, high, high } };
+}
+
+WaveshaperTableSet::Curves MultibandShaper::getCurves(const Layout& layout) noexcept
+{
+    WaveshaperTableSet::Curves curves;
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        const auto source = (size_t)juce::jmin(band, layout.numBands - 1);
+        curves[(size_t)band] = { layout.clipLevel[source], layout.exponent[source], layout.outputScale[source] };
+    }
+
+    return curves;
+}
+
+void MultibandShaper::process(float* const* bands, const float* input, int numSamples,
+                              float drive, const float* driveRamp, const Layout& layout) noexcept
+{
+    if (driveRamp != nullptr)
+        processVectorised<true>(bands, input, numSamples, drive, driveRamp, layout);
+    else
+        processVectorised<false>(bands, input, numSamples, drive, nullptr, layout);
+}
+
+template <bool Ramped>
+void MultibandShaper::processVectorised(float* const* bands, const float* input, int numSamples,
+                                        float drive, const float* driveRamp, const Layout& layout) noexcept
+{
+    const int numBands = layout.numBands;
+    auto driveVector = SimdFloat::broadcast(drive * 6.2f);
+    const auto one = SimdFloat::broadcast(1.0f);
+    SimdFloat shaped[maxBands];
+    int sample = 0;
+
+    for (; sample + SimdFloat::size <= numSamples; sample += SimdFloat::size)
+    {
+        if constexpr (Ramped)
+            driveVector = SimdFloat::load(driveRamp + sample) * 6.2f;
+
+        // Adaptive Gain Compensation for Sustain, shared by all bands
+        const auto inputGainComp = one + SimdFloat::broadcast(0.22f) / (SimdFloat::abs(SimdFloat::load(input + sample)) + 0.12f);
+        const auto adaptiveDrive = driveVector * inputGainComp;
+        auto weightedSum = SimdFloat::broadcast(0.0f);
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            const auto index = (size_t)band;
+            auto bandSample = SimdFloat::load(bands[band] + sample) * SimdFloat::mulAdd(adaptiveDrive, SimdFloat::broadcast(layout.drive[index]), one);
+            bandSample = SimdFloat::clamp(bandSample, -layout.clipLevel[index], layout.clipLevel[index]);
+            bandSample = FastMath::signedPow(bandSample, SimdFloat::broadcast(layout.exponent[index])) * layout.outputScale[index];
+
+            weightedSum = SimdFloat::mulAdd(bandSample, SimdFloat::broadcast(layout.weight[index]), weightedSum);
+            shaped[band] = bandSample;
+        }
+
+        // Dynamic Control
+        const auto dynamicSmoothing = one / (one + SimdFloat::abs(weightedSum));
+
+        for (int band = 0; band < numBands; ++band)
+            (shaped[band] * (dynamicSmoothing * layout.makeup[(size_t)band])).store(bands[band] + sample);
+    }
+
+    float* remainingBands[maxBands];
+
+    for (int band = 0; band < numBands; ++band)
+        remainingBands[band] = bands[band] + sample;
+
+    processReference(remainingBands, input + sample, numSamples - sample, drive, Ramped ? driveRamp + sample : nullptr, layout);
+}
+
+void MultibandShaper::processReference(float* const* bands, const float* input, int numSamples,
+                                       float drive, const float* driveRamp, const Layout& layout) noexcept
+{
+    const int numBands = layout.numBands;
+    float shaped[maxBands];
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        float inputSample = input[sample];
+        float sampleDrive = (driveRamp != nullptr ? driveRamp[sample] : drive) * 6.2f;
+
+        // Adaptive Gain Compensation for Sustain
+        float inputGainComp = 1.0f + (0.22f / (0.12f + std::abs(inputSample)));
+        float adaptiveDrive = sampleDrive * inputGainComp;
+        float weightedSum = 0.0f;
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            const auto index = (size_t)band;
+            float bandSample = bands[band][sample] * (1.0f + adaptiveDrive * layout.drive[index]);
+            bandSample = juce::jlimit<float>(-layout.clipLevel[index], layout.clipLevel[index], bandSample);
+            bandSample = (bandSample > 0.0f ? std::pow(bandSample, layout.exponent[index]) : -std::pow(-bandSample, layout.exponent[index]));
+            bandSample *= layout.outputScale[index];
+
+            weightedSum += bandSample * layout.weight[index];
+            shaped[band] = bandSample;
+        }
+
+        // Dynamic Control
+        float dynamicSmoothing = 1.0f / (1.0f + std::abs(weightedSum));
+
+        for (int band = 0; band < numBands; ++band)
+            bands[band][sample] = shaped[band] * dynamicSmoothing * layout.makeup[(size_t)band];
+    }
+}
+
+void MultibandShaper::processWithTables(float* const* bands, const float* input, int numSamples, float drive, const float* driveRamp,
+                                        const Layout& layout, const WaveshaperTableSet::Tables& tables) noexcept
+{
+    if (driveRamp != nullptr)
+        processTables<true>(bands, input, numSamples, drive, driveRamp, layout, tables);
+    else
+        processTables<false>(bands, input, numSamples, drive, nullptr, layout, tables);
+}
+
+template <bool Ramped>
+void MultibandShaper::processTables(float* const* bands, const float* input, int numSamples, float drive, const float* driveRamp,
+                                    const Layout& layout, const WaveshaperTableSet::Tables& tables) noexcept
+{
+    const int numBands = layout.numBands;
+    float shaped[maxBands];
+    drive *= 6.2f;
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        if constexpr (Ramped)
+            drive = driveRamp[sample] * 6.2f;
+
+        // Adaptive Gain Compensation for Sustain
+        float inputGainComp = 1.0f + (0.22f / (0.12f + std::abs(input[sample])));
+        float adaptiveDrive = drive * inputGainComp;
+        float weightedSum = 0.0f;
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            const auto index = (size_t)band;
+            shaped[band] = tables.bands[index].processSample(bands[band][sample] * (1.0f + adaptiveDrive * layout.drive[index]));
+            weightedSum += shaped[band] * layout.weight[index];
+        }
+
+        // Dynamic Control
+        float dynamicSmoothing = 1.0f / (1.0f + std::abs(weightedSum));
+
+        for (int band = 0; band < numBands; ++band)
+            bands[band][sample] = shaped[band] * dynamicSmoothing * layout.makeup[(size_t)band];
+    }
+}
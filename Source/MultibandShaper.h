@@ -0,0 +1,92 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "WaveshaperTable.h"
+
+//==============================================================================
+/** User settings of one shaper band. */
+struct BandShape
+{
+    static constexpr float maxDrive = 2.0f;
+    static constexpr float minClipLevel = 0.05f, maxClipLevel = 1.0f;
+    static constexpr float minExponent = 0.25f, maxExponent = 2.5f;
+
+    float drive;        // How strongly the adaptive drive pushes the band into its curve
+    float clipLevel;    // Hard clip ahead of the curve
+    float exponent;     // Signed power applied after the clip
+
+    bool operator==(const BandShape& other) const noexcept
+    {
+        return drive == other.drive && clipLevel == other.clipLevel && exponent == other.exponent;
+    }
+
+    bool operator!=(const BandShape& other) const noexcept { return !operator==(other); }
+};
+
+//==============================================================================
+/**
+    The multiband waveshaping stage of the distortion, for 2 to 6 bands.
+
+    Every band is driven, clipped, raised to its exponent and scaled, then all
+    bands share one dynamic control. The lowest band is voiced like the original
+    low band, the highest like the high band and everything in between like the
+    mid band; the default three-band layout is the original low/mid/high shaper.
+
+    process() is the vectorised kernel, working on SimdFloat::size samples per
+    iteration. The input level and drive work is shared by all bands, so each
+    extra band only adds its own clip, power and scale. processReference() is
+    the scalar definition of the sound: the two never differ by more than
+    tolerance.
+*/
+class MultibandShaper
+{
+public:
+    static constexpr int minBands = 2;
+    static constexpr int maxBands = WaveshaperTableSet::maxBands;
+
+    /** Largest absolute difference allowed between process() and processReference(). */
+    static constexpr float tolerance = 1.0e-6f;
+
+    using BandShapes = std::array<BandShape, maxBands>;
+
+    /** Per-band constants of the kernels for one band count and set of shapes. */
+    struct Layout
+    {
+        int numBands = 0;
+        std::array<float, maxBands> drive {}, clipLevel {}, exponent {}, outputScale {}, weight {}, makeup {};
+    };
+
+    static Layout makeLayout(int numBands, const BandShapes& shapes) noexcept;
+
+    /** Low, mid and high shapes of the original voicing, the high one repeated for bands 4 to 6. */
+    static BandShapes getDefaultShapes() noexcept;
+
+    /** The transfer curves of a layout, for the lookup tables and ADAA. Unused bands repeat the last one. */
+    static WaveshaperTableSet::Curves getCurves(const Layout& layout) noexcept;
+
+    /** Shapes one channel of layout.numBands bands in place.
+        input is the unsplit signal that drives the adaptive gain compensation,
+        drive is the raw 0..1 drive parameter. While drive is being automated,
+        driveRamp holds one raw drive value per sample and drive is ignored;
+        pass nullptr to use the constant.
+    */
+    static void process(float* const* bands, const float* input, int numSamples,
+                        float drive, const float* driveRamp, const Layout& layout) noexcept;
+
+    /** Scalar reference implementation of process(). */
+    static void processReference(float* const* bands, const float* input, int numSamples,
+                                 float drive, const float* driveRamp, const Layout& layout) noexcept;
+
+    /** Same as process(), but reads the band curves from lookup tables built from getCurves(). */
+    static void processWithTables(float* const* bands, const float* input, int numSamples, float drive, const float* driveRamp,
+                                  const Layout& layout, const WaveshaperTableSet::Tables& tables) noexcept;
+
+private:
+    template <bool Ramped>
+    static void processVectorised(float* const* bands, const float* input, int numSamples,
+                                  float drive, const float* driveRamp, const Layout& layout) noexcept;
+
+    template <bool Ramped>
+    static void processTables(float* const* bands, const float* input, int numSamples, float drive, const float* driveRamp,
+                              const Layout& layout, const WaveshaperTableSet::Tables& tables) noexcept;
+};
@@ -0,0 +1,30 @@
+#include "NoiseGate.h"
+
+template <typename SampleType>
+void NoiseGate<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    attackCoeff = (SampleType)std::exp(-1.0 / (attackTime * spec.sampleRate));
+    releaseCoeff = (SampleType)std::exp(-1.0 / (releaseTime * spec.sampleRate));
+
+    gains.resize((size_t)spec.numChannels);
+    reset();
+}
+
+template <typename SampleType>
+void NoiseGate<SampleType>::reset() noexcept
+{
+    std::fill(gains.begin(), gains.end(), SampleType(1));
+}
+
+template <typename SampleType>
+void NoiseGate<SampleType>::setThresholdDecibels(float newThresholdDecibels) noexcept
+{
+    if (newThresholdDecibels != thresholdDecibels)
+    {
+        thresholdDecibels = newThresholdDecibels;
+        threshold = juce::Decibels::decibelsToGain((SampleType)newThresholdDecibels);
+    }
+}
+
+template class NoiseGate<float>;
+template class NoiseGate<double>;
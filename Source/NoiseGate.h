@@ -0,0 +1,75 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Noise gate with its own envelope per channel.
+
+    The ballistics are computed in prepare() and the threshold only when it
+    changes, so processing is a branchless multiply-add per sample. In stereo
+    linked mode all channels share one envelope driven by the loudest channel.
+*/
+template <typename SampleType>
+class NoiseGate
+{
+public:
+    NoiseGate() = default;
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset() noexcept;
+
+    void setThresholdDecibels(float newThresholdDecibels) noexcept;
+    void setStereoLinked(bool shouldBeLinked) noexcept { stereoLinked = shouldBeLinked; }
+
+    /** Gates one sample of each of the first numChannels channels. */
+    void processFrame(SampleType* frame, int numChannels) noexcept
+    {
+        jassert(numChannels <= (int)gains.size());
+
+        if (stereoLinked && numChannels > 1)
+        {
+            SampleType detector = 0;
+            for (int channel = 0; channel < numChannels; ++channel)
+                detector = juce::jmax(detector, std::abs(frame[channel]));
+
+            const SampleType gain = getNextGain(gains[0], detector);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                gains[(size_t)channel] = gain;
+                frame[channel] *= gain;
+            }
+
+            return;
+        }
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            gains[(size_t)channel] = getNextGain(gains[(size_t)channel], std::abs(frame[channel]));
+            frame[channel] *= gains[(size_t)channel];
+        }
+    }
+
+    static constexpr float attackTime = 0.01f; // Seconds to close below the threshold
+    static constexpr float releaseTime = 0.1f; // Seconds to open above it
+
+private:
+    SampleType getNextGain(SampleType gain, SampleType detector) const noexcept
+    {
+        const bool open = detector >= threshold;
+        const SampleType coeff = open ? releaseCoeff : attackCoeff;
+        const SampleType target = open ? SampleType(1) : SampleType(0);
+        return target + coeff * (gain - target);
+    }
+
+    SampleType attackCoeff = 0;
+    SampleType releaseCoeff = 0;
+    float thresholdDecibels = std::numeric_limits<float>::lowest();
+    SampleType threshold = 0;
+    bool stereoLinked = true;
+
+    std::vector<SampleType> gains; // Current gain of each channel
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NoiseGate)
+};
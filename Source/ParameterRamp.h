@@ -0,0 +1,76 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Smooths one parameter and hands its values out a block at a time.
+
+    The caller reads the parameter once per block and passes it to advance().
+    While the value is still moving, advance() writes one value per sample into
+    a buffer allocated in prepare() and getRamp() returns it. Once the value has
+    settled getRamp() returns nullptr, so kernels can take their constant path
+    and use getCurrentValue() instead.
+*/
+template <typename SmoothingType = juce::ValueSmoothingTypes::Linear>
+class ParameterRamp
+{
+public:
+    ParameterRamp() = default;
+
+    /** Allocates room for ramps of up to maxSamples and jumps to initialValue. */
+    void prepare(double sampleRate, double rampLengthSeconds, int maxSamples, float initialValue)
+    {
+        rampLength = rampLengthSeconds;
+        ramp.allocate((size_t)maxSamples, true);
+        maxRampSamples = maxSamples;
+        smoother.reset(sampleRate, rampLength);
+        smoother.setCurrentAndTargetValue(initialValue);
+        ramping = false;
+    }
+
+    /** Changes the rate the ramp is generated at (e.g. when the oversampling factor
+        changes) and jumps straight to the current target.
+    */
+    void setSampleRate(double sampleRate) noexcept
+    {
+        smoother.reset(sampleRate, rampLength);
+        ramping = false;
+    }
+
+    /** Moves towards target over the next numSamples samples. */
+    void advance(float target, int numSamples) noexcept
+    {
+        jassert(numSamples <= maxRampSamples);
+
+        smoother.setTargetValue(target);
+        ramping = smoother.isSmoothing();
+
+        if (ramping)
+            for (int sample = 0; sample < numSamples; ++sample)
+                ramp[sample] = smoother.getNextValue();
+    }
+
+    /** Moves towards target by numSamples without generating any values, for blocks that are skipped. */
+    void skip(float target, int numSamples) noexcept
+    {
+        smoother.setTargetValue(target);
+        smoother.skip(numSamples);
+        ramping = false;
+    }
+
+    /** The per-sample values of the last advance(), or nullptr if the value was constant. */
+    const float* getRamp() const noexcept { return ramping ? ramp.get() : nullptr; }
+
+    /** The value reached at the end of the last advance(). */
+    float getCurrentValue() const noexcept { return smoother.getCurrentValue(); }
+
+private:
+    juce::SmoothedValue<float, SmoothingType> smoother;
+    juce::HeapBlock<float> ramp;
+    double rampLength = 0.05;
+    int maxRampSamples = 0;
+    bool ramping = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterRamp)
+};
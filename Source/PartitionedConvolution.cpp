@@ -0,0 +1,348 @@
+#include "PartitionedConvolution.h"
+#include "SimdFloat.h"
+
+PartitionedConvolution::PartitionedConvolution(const juce::AudioBuffer<float>& impulseResponse, int numChannelsToUse, bool runTailOnWorker)
+    : juce::Thread("DISTROAR Convolution"),
+      headFft(headFftOrder),
+      tailFft(tailFftOrder),
+      numChannels(numChannelsToUse),
+      useWorker(runTailOnWorker)
+{
+    jassert(numChannels > 0 && impulseResponse.getNumChannels() > 0);
+
+    numKernels = juce::jmin(numChannels, impulseResponse.getNumChannels());
+    lengthSamples = impulseResponse.getNumSamples();
+
+    const int headLength = juce::jmin(lengthSamples, tailOffset);
+    numHeadPartitions = juce::jmax(0, (headLength - headSize + headSize - 1) / headSize);
+    numTailPartitions = juce::jmax(0, (lengthSamples - tailOffset + tailSize - 1) / tailSize);
+
+    directTaps.assign((size_t)(numKernels * headSize), 0.0f);
+    headKernels.assign((size_t)(numKernels * numHeadPartitions * headBins), {});
+    tailKernels.assign((size_t)(numKernels * numTailPartitions * tailBins), {});
+    headFftBuffer.assign((size_t)(4 * headSize), 0.0f);
+    tailFftBuffer.assign((size_t)(4 * tailSize), 0.0f);
+
+    // One spectrum per partition, each partition zero padded to twice its size
+    auto transform = [&](const float* taps, int start, int partitionSize, const juce::dsp::FFT& fft,
+                         std::vector<float>& buffer, Complex* destination)
+    {
+        std::fill(buffer.begin(), buffer.end(), 0.0f);
+        const int numTaps = juce::jmin(partitionSize, lengthSamples - start);
+        std::copy(taps + start, taps + start + numTaps, buffer.begin());
+        fft.performRealOnlyForwardTransform(buffer.data(), true);
+
+        auto* bins = reinterpret_cast<const Complex*>(buffer.data());
+        std::copy(bins, bins + partitionSize + 1, destination);
+    };
+
+    for (int kernel = 0; kernel < numKernels; ++kernel)
+    {
+        const auto* taps = impulseResponse.getReadPointer(kernel);
+        auto* direct = directTaps.data() + kernel * headSize;
+
+        for (int i = 0; i < juce::jmin(headSize, lengthSamples); ++i)
+            direct[headSize - 1 - i] = taps[i];
+
+        for (int partition = 0; partition < numHeadPartitions; ++partition)
+            transform(taps, (partition + 1) * headSize, headSize, headFft, headFftBuffer,
+                      headKernels.data() + (kernel * numHeadPartitions + partition) * headBins);
+
+        for (int partition = 0; partition < numTailPartitions; ++partition)
+            transform(taps, tailOffset + partition * tailSize, tailSize, tailFft, tailFftBuffer,
+                      tailKernels.data() + (kernel * numTailPartitions + partition) * tailBins);
+    }
+
+    headInput.setSize(numChannels, 2 * headSize);
+    headSpectra.assign((size_t)(numChannels * numHeadPartitions * headBins), {});
+    headOutput.setSize(numChannels, headSize);
+    headAccumulator.assign((size_t)headBins, {});
+
+    if (numTailPartitions > 0)
+    {
+        tailInput.setSize(numChannels, tailInputBlocks * tailSize);
+        tailOutput.setSize(numChannels, tailOutputBlocks * tailSize);
+        tailSpectra.assign((size_t)(numChannels * numTailPartitions * tailBins), {});
+        tailAccumulator.assign((size_t)tailBins, {});
+    }
+
+    for (auto& stamp : tailInputStamps)
+        stamp = -1;
+
+    for (auto& stamp : tailOutputStamps)
+        stamp = -1;
+
+    reset();
+
+    if (useWorker && numTailPartitions > 0)
+        startThread(juce::Thread::Priority::high);
+}
+
+PartitionedConvolution::~PartitionedConvolution()
+{
+    stopThread(-1);
+}
+
+void PartitionedConvolution::reset() noexcept
+{
+    headInput.clear();
+    headOutput.clear();
+    std::fill(headSpectra.begin(), headSpectra.end(), Complex());
+    newestHeadSpectrum = 0;
+    headFill = 0;
+
+    // The tail keeps counting blocks, the block in progress just starts again. Everything
+    // the tail computed from earlier input is ignored, and its history cleared before the
+    // first block after this one is computed.
+    tailFill = 0;
+    tailResetBlock.store(tailBlocksWritten.load(std::memory_order_relaxed), std::memory_order_release);
+    startTailBlock();
+}
+
+void PartitionedConvolution::process(float* const* channels, int numSamples) noexcept
+{
+    for (int done = 0; done < numSamples;)
+    {
+        // Tail blocks are whole head blocks, so both boundaries fall between passes of this loop
+        const int numToDo = juce::jmin(numSamples - done, headSize - headFill);
+        const int tailPosition = (int)(tailBlocksWritten.load(std::memory_order_relaxed) % tailInputBlocks) * tailSize + tailFill;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* data = channels[channel] + done;
+            auto* block = headInput.getWritePointer(channel);
+            const auto* taps = directTaps.data() + getKernel(channel) * headSize;
+            const auto* head = headOutput.getReadPointer(channel, headFill);
+            float* tailIn = writingTailInput ? tailInput.getWritePointer(channel, tailPosition) : nullptr;
+            const float* tail = playingTailSlot >= 0 ? tailOutput.getReadPointer(channel, playingTailSlot * tailSize + tailFill) : nullptr;
+
+            for (int i = 0; i < numToDo; ++i)
+            {
+                const int position = headFill + i;
+                block[headSize + position] = data[i];
+
+                if (tailIn != nullptr)
+                    tailIn[i] = data[i];
+
+                // The direct taps cover the newest headSize inputs, the partitions everything older
+                float output = dotProduct(taps, block + position + 1) + head[i];
+
+                if (tail != nullptr)
+                    output += tail[i];
+
+                data[i] = output;
+            }
+        }
+
+        headFill += numToDo;
+        tailFill += numToDo;
+        done += numToDo;
+
+        if (headFill == headSize)
+        {
+            processHeadBlock();
+            headFill = 0;
+        }
+
+        if (tailFill == tailSize)
+        {
+            finishTailBlock();
+            tailFill = 0;
+            startTailBlock();
+        }
+    }
+}
+
+void PartitionedConvolution::processHeadBlock() noexcept
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* block = headInput.getWritePointer(channel);
+
+        if (numHeadPartitions > 0)
+        {
+            // Overlap-save: transform the last two blocks of input and keep the spectrum
+            std::copy(block, block + 2 * headSize, headFftBuffer.begin());
+            std::fill(headFftBuffer.begin() + 2 * headSize, headFftBuffer.end(), 0.0f);
+            headFft.performRealOnlyForwardTransform(headFftBuffer.data(), true);
+
+            auto* spectra = headSpectra.data() + channel * numHeadPartitions * headBins;
+            auto* bins = reinterpret_cast<const Complex*>(headFftBuffer.data());
+            std::copy(bins, bins + headBins, spectra + newestHeadSpectrum * headBins);
+
+            // The next block's output: the newest spectrum meets the first partition after the direct taps
+            const auto* kernel = headKernels.data() + getKernel(channel) * numHeadPartitions * headBins;
+            std::fill(headAccumulator.begin(), headAccumulator.end(), Complex());
+
+            for (int partition = 0; partition < numHeadPartitions; ++partition)
+            {
+                const int slot = (newestHeadSpectrum - partition + numHeadPartitions) % numHeadPartitions;
+                multiplyAccumulate(spectra + slot * headBins, kernel + partition * headBins, headAccumulator.data(), headBins);
+            }
+
+            std::fill(headFftBuffer.begin(), headFftBuffer.end(), 0.0f);
+            std::copy(headAccumulator.begin(), headAccumulator.end(), reinterpret_cast<Complex*>(headFftBuffer.data()));
+            headFft.performRealOnlyInverseTransform(headFftBuffer.data());
+
+            // The second half is the part of the circular convolution that is free of wrap-around
+            std::copy(headFftBuffer.begin() + headSize, headFftBuffer.begin() + 2 * headSize, headOutput.getWritePointer(channel));
+        }
+
+        // Slide the input along by one block
+        std::copy(block + headSize, block + 2 * headSize, block);
+    }
+
+    if (numHeadPartitions > 0)
+        newestHeadSpectrum = (newestHeadSpectrum + 1) % numHeadPartitions;
+}
+
+void PartitionedConvolution::finishTailBlock() noexcept
+{
+    if (numTailPartitions == 0)
+        return;
+
+    const auto block = tailBlocksWritten.load(std::memory_order_relaxed);
+
+    if (writingTailInput)
+        tailInputStamps[(size_t)(block % tailInputBlocks)].store(block, std::memory_order_release);
+
+    tailBlocksWritten.store(block + 1, std::memory_order_release);
+
+    if (useWorker)
+        notify();
+    else
+        computeTailBlock(nextTailJob++);
+}
+
+void PartitionedConvolution::startTailBlock() noexcept
+{
+    playingTailSlot = -1;
+    writingTailInput = false;
+
+    if (numTailPartitions == 0)
+        return;
+
+    // The slot for this block last held the block tailInputBlocks earlier, which the block after
+    // it still reads. If the worker has fallen that far behind, this block's input is dropped.
+    const auto block = tailBlocksWritten.load(std::memory_order_relaxed);
+    writingTailInput = tailBlocksComputed.load(std::memory_order_acquire) >= block - tailInputBlocks + 2;
+
+    // The output of input block b starts at block b + 2, so the first two blocks after a reset have none
+
+    if (block - 2 < tailResetBlock.load(std::memory_order_relaxed))
+        return;
+
+    const int slot = (int)(block % tailOutputBlocks);
+
+    if (tailOutputStamps[(size_t)slot].load(std::memory_order_acquire) == block)
+        playingTailSlot = slot;
+    else
+        ++missedDeadlines;
+}
+
+void PartitionedConvolution::run()
+{
+    while (! threadShouldExit())
+    {
+        if (nextTailJob < tailBlocksWritten.load(std::memory_order_acquire))
+            computeTailBlock(nextTailJob++);
+        else
+            wait(-1);
+    }
+}
+
+void PartitionedConvolution::computeTailBlock(juce::int64 block) noexcept
+{
+    const auto resetBlock = tailResetBlock.load(std::memory_order_acquire);
+    const bool firstAfterReset = block == resetBlock;
+
+    if (block >= resetBlock && clearedAtBlock != resetBlock)
+    {
+        std::fill(tailSpectra.begin(), tailSpectra.end(), Complex());
+        clearedAtBlock = resetBlock;
+    }
+
+    // A block whose output is already being played is still transformed to keep the history
+    // complete, but nothing is computed from it. That is how the worker catches up.
+    const bool late = tailBlocksWritten.load(std::memory_order_acquire) >= block + 2;
+    const int inputSlot = (int)(block % tailInputBlocks);
+    const int previousSlot = (int)((block + tailInputBlocks - 1) % tailInputBlocks);
+    const int outputSlot = (int)((block + 2) % tailOutputBlocks);
+
+    // Dropped input is silence, and so is the block before the first one after a reset
+    const bool hasInput = tailInputStamps[(size_t)inputSlot].load(std::memory_order_acquire) == block;
+    const bool hasPrevious = ! firstAfterReset && tailInputStamps[(size_t)previousSlot].load(std::memory_order_acquire) == block - 1;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        // Overlap-save over this block and the one before it
+        std::fill(tailFftBuffer.begin(), tailFftBuffer.end(), 0.0f);
+
+        if (hasPrevious)
+            std::copy_n(tailInput.getReadPointer(channel, previousSlot * tailSize), tailSize, tailFftBuffer.begin());
+
+        if (hasInput)
+            std::copy_n(tailInput.getReadPointer(channel, inputSlot * tailSize), tailSize, tailFftBuffer.begin() + tailSize);
+
+        tailFft.performRealOnlyForwardTransform(tailFftBuffer.data(), true);
+
+        auto* spectra = tailSpectra.data() + channel * numTailPartitions * tailBins;
+        auto* bins = reinterpret_cast<const Complex*>(tailFftBuffer.data());
+        std::copy(bins, bins + tailBins, spectra + newestTailSpectrum * tailBins);
+
+        if (late)
+            continue;
+
+        const auto* kernel = tailKernels.data() + getKernel(channel) * numTailPartitions * tailBins;
+        std::fill(tailAccumulator.begin(), tailAccumulator.end(), Complex());
+
+        for (int partition = 0; partition < numTailPartitions; ++partition)
+        {
+            const int slot = (newestTailSpectrum - partition + numTailPartitions) % numTailPartitions;
+            multiplyAccumulate(spectra + slot * tailBins, kernel + partition * tailBins, tailAccumulator.data(), tailBins);
+        }
+
+        std::fill(tailFftBuffer.begin(), tailFftBuffer.end(), 0.0f);
+        std::copy(tailAccumulator.begin(), tailAccumulator.end(), reinterpret_cast<Complex*>(tailFftBuffer.data()));
+        tailFft.performRealOnlyInverseTransform(tailFftBuffer.data());
+        std::copy_n(tailFftBuffer.begin() + tailSize, tailSize, tailOutput.getWritePointer(channel, outputSlot * tailSize));
+    }
+
+    newestTailSpectrum = (newestTailSpectrum + 1) % numTailPartitions;
+
+    if (! late)
+        tailOutputStamps[(size_t)outputSlot].store(block + 2, std::memory_order_release);
+
+    tailBlocksComputed.store(block + 1, std::memory_order_release);
+}
+
+void PartitionedConvolution::multiplyAccumulate(const Complex* x, const Complex* h, Complex* accumulator, int numBins) noexcept
+{
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        // Written out, std::complex multiplication checks for infinities on every call
+        const float re = x[bin].real() * h[bin].real() - x[bin].imag() * h[bin].imag();
+        const float im = x[bin].real() * h[bin].imag() + x[bin].imag() * h[bin].real();
+        accumulator[bin] += Complex(re, im);
+    }
+}
+
+float PartitionedConvolution::dotProduct(const float* a, const float* b) noexcept
+{
+    static_assert(headSize % SimdFloat::size == 0, "The direct taps must fill whole registers");
+
+    auto sum = SimdFloat::broadcast(0.0f);
+
+    for (int i = 0; i < headSize; i += SimdFloat::size)
+        sum = SimdFloat::mulAdd(SimdFloat::load(a + i), SimdFloat::load(b + i), sum);
+
+    float lanes[SimdFloat::size];
+    sum.store(lanes);
+
+    float result = 0.0f;
+
+    for (auto lane : lanes)
+        result += lane;
+
+    return result;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Zero-latency, non-uniformly partitioned convolution for long impulse responses.
+
+    The response is cut into three segments:
+    - the first headSize taps run as a direct FIR, sample by sample,
+    - the taps up to tailOffset run as uniform partitions of headSize by FFT,
+      both on the audio thread,
+    - the rest runs as partitions of tailSize on a worker thread.
+
+    A tail block goes to the worker as soon as its input is complete, and its
+    result is only needed a whole tail block later, which is the worker's
+    deadline. Results go into a small ring of output blocks stamped with the block
+    they belong to. A result that is not ready in time is left out and counted,
+    never waited for. The audio thread's work per sample is the same however long
+    the response is.
+
+    Without the worker, the tail blocks are computed inside process() instead,
+    which makes the output deterministic for offline rendering.
+*/
+class PartitionedConvolution : private juce::Thread
+{
+public:
+    static constexpr int headSize = 64;
+    static constexpr int tailSize = 1024;
+    static constexpr int tailOffset = 2 * tailSize;     // Leaves the worker one tail block to finish in
+
+    /** Transforms the response and allocates all state, then starts the worker if the
+        response reaches the tail. Not for the audio thread.
+        Channels past the last channel of the response use its last channel.
+    */
+    PartitionedConvolution(const juce::AudioBuffer<float>& impulseResponse, int numChannels, bool useWorker);
+    ~PartitionedConvolution() override;
+
+    /** Clears all history, so only input from now on is heard. Audio thread only. */
+    void reset() noexcept;
+
+    /** Convolves numSamples samples of every channel in place. */
+    void process(float* const* channels, int numSamples) noexcept;
+
+    int getNumChannels() const noexcept { return numChannels; }
+    int getLengthSamples() const noexcept { return lengthSamples; }
+
+    /** Tail blocks that were not ready in time and were left out, since construction. */
+    int getNumMissedDeadlines() const noexcept { return missedDeadlines.load(); }
+
+private:
+    using Complex = std::complex<float>;
+
+    static constexpr int headFftOrder = 7;
+    static constexpr int tailFftOrder = 11;
+    static constexpr int headBins = headSize + 1;
+    static constexpr int tailBins = tailSize + 1;
+
+    // Input kept for the worker, and results waiting to be played, in tail blocks
+    static constexpr int tailInputBlocks = 8;
+    static constexpr int tailOutputBlocks = 4;
+
+    void run() override;
+
+    void processHeadBlock() noexcept;
+    void finishTailBlock() noexcept;
+    void startTailBlock() noexcept;
+    void computeTailBlock(juce::int64 block) noexcept;
+
+    static void multiplyAccumulate(const Complex* x, const Complex* h, Complex* accumulator, int numBins) noexcept;
+    static float dotProduct(const float* a, const float* b) noexcept;
+
+    int getKernel(int channel) const noexcept { return juce::jmin(channel, numKernels - 1); }
+
+    juce::dsp::FFT headFft, tailFft;
+    const int numChannels;
+    int numKernels = 0;
+    int lengthSamples = 0;
+    int numHeadPartitions = 0;
+    int numTailPartitions = 0;
+
+    // Per kernel: the first headSize taps reversed, then the spectra of both partition sizes
+    std::vector<float> directTaps;
+    std::vector<Complex> headKernels;
+    std::vector<Complex> tailKernels;
+
+    // Audio thread. Per channel, the last two head blocks of input, a ring of their
+    // spectra and the output of the head partitions for the block being played.
+    juce::AudioBuffer<float> headInput;
+    std::vector<Complex> headSpectra;
+    juce::AudioBuffer<float> headOutput;
+    std::vector<float> headFftBuffer;
+    std::vector<Complex> headAccumulator;
+    int newestHeadSpectrum = 0;
+    int headFill = 0;
+    int tailFill = 0;
+    int playingTailSlot = -1;   // Where the output of the tail block being played is, -1 if it has none
+    bool writingTailInput = false;
+
+    // Shared with the worker. Input block b is at b % tailInputBlocks and output block b at
+    // b % tailOutputBlocks, and either is only read if its stamp says it is block b. Neither
+    // side ever writes a slot the other may still be reading.
+    juce::AudioBuffer<float> tailInput;
+    juce::AudioBuffer<float> tailOutput;
+    std::array<std::atomic<juce::int64>, tailInputBlocks> tailInputStamps;
+    std::array<std::atomic<juce::int64>, tailOutputBlocks> tailOutputStamps;
+    std::atomic<juce::int64> tailBlocksWritten { 0 };
+    std::atomic<juce::int64> tailBlocksComputed { 0 };
+    std::atomic<juce::int64> tailResetBlock { 0 };  // The first block after the latest reset
+    std::atomic<int> missedDeadlines { 0 };
+    const bool useWorker;
+
+    // Whoever computes the tail: the worker, or process() without one
+    std::vector<Complex> tailSpectra;
+    std::vector<float> tailFftBuffer;
+    std::vector<Complex> tailAccumulator;
+    int newestTailSpectrum = 0;
+    juce::int64 nextTailJob = 0;
+    juce::int64 clearedAtBlock = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PartitionedConvolution)
+};
@@ -4,7 +4,9 @@
 
 //==============================================================================
 DISTROARAudioProcessorEditor::DISTROARAudioProcessorEditor(DISTROARAudioProcessor& p)
-    : AudioProcessorEditor(&p), audioProcessor(p), effectEnabled(true) // Initialize effectEnabled
+    : AudioProcessorEditor(&p),
+      bypassAttachment(*p.bypassParameter, [this](float bypassed) { updateToggleButton(bypassed < 0.5f); }),
+      audioProcessor(p)
 {
     // Load background image
     backgroundImage = juce::ImageCache::getFromMemory(BinaryData::distroarBackground_png, BinaryData::distroarBackground_pngSize)
@@ -15,11 +17,8 @@ DISTROARAudioProcessorEditor::DISTROARAudioProcessorEditor(DISTROARAudioProcesso
     buttonOnImage = juce::ImageFileFormat::loadFrom(BinaryData::distroarON_png, BinaryData::distroarON_pngSize);
     buttonOffImage = juce::ImageFileFormat::loadFrom(BinaryData::distroarOFF_png, BinaryData::distroarOFF_pngSize);
 
-    // Set initial images to the toggleButton based on effectEnabled state
-    toggleButton.setImages(false, true, true,
-        effectEnabled ? buttonOnImage : buttonOffImage, 1.0f, juce::Colours::transparentBlack,
-        effectEnabled ? buttonOnImage : buttonOffImage, 1.0f, juce::Colours::transparentBlack,
-        effectEnabled ? buttonOnImage : buttonOffImage, 1.0f, juce::Colours::transparentBlack);
+    // Set initial images to the toggleButton based on the bypass state
+    bypassAttachment.sendInitialUpdate();
 
     addAndMakeVisible(toggleButton);
     toggleButton.addListener(this);
@@ -188,21 +187,81 @@ void DISTROARAudioProcessorEditor::buttonClicked(juce::Button* button)
 {
     if (button == &toggleButton)
     {
-        // Toggle the effect state
-        effectEnabled = !effectEnabled;
+        // Toggle the bypass parameter, the attachment updates the button images
+        bypassAttachment.setValueAsCompleteGesture(audioProcessor.bypassParameter->get() ? 0.0f : 1.0f);
+    }
+}
 
-        // Update the button images based on the effect state
-        toggleButton.setImages(false, true, true,
-            effectEnabled ? buttonOnImage : buttonOffImage, 1.0f, juce::Colours::transparentBlack,
-            effectEnabled ? buttonOnImage : buttonOffImage, 1.0f, juce::Colours::transparentBlack,
-            effectEnabled ? buttonOnImage : buttonOffImage, 1.0f, juce::Colours::transparentBlack);
+void DISTROARAudioProcessorEditor::updateToggleButton(bool effectEnabled)
+{
+    toggleButton.setImages(false, true, true,
+        effectEnabled ? buttonOnImage : buttonOffImage, 1.0f, juce::Colours::transparentBlack,
+        effectEnabled ? buttonOnImage : buttonOffImage, 1.0f, juce::Colours::transparentBlack,
+        effectEnabled ? buttonOnImage : buttonOffImage, 1.0f, juce::Colours::transparentBlack);
+}
 
-        audioProcessor.setEffectEnabled(effectEnabled);
+void DISTROARAudioProcessorEditor::showCabinetMenu()
+{
+    const auto impulseResponse = audioProcessor.getImpulseResponse();
+    const bool hasImpulseResponse = impulseResponse.file != juce::File();
+
+    juce::PopupMenu lengthMenu;
+
+    for (double seconds : { 0.1, 0.25, 0.5, 1.0, 2.0, 3.0 })
+    {
+        lengthMenu.addItem(juce::String(seconds) + " s", true, impulseResponse.lengthLimitSeconds == seconds, [this, seconds]
+        {
+            auto settings = audioProcessor.getImpulseResponse();
+            settings.lengthLimitSeconds = seconds;
+            audioProcessor.setImpulseResponse(settings);
+        });
     }
+
+    juce::PopupMenu menu;
+    menu.addSectionHeader(hasImpulseResponse ? "Cabinet IR: " + impulseResponse.file.getFileName() : juce::String("Cabinet IR: built-in"));
+    menu.addItem("Load Cabinet IR...", [this] { chooseImpulseResponseFile(); });
+    menu.addItem("Clear Cabinet IR", hasImpulseResponse, false, [this]
+    {
+        auto settings = audioProcessor.getImpulseResponse();
+        settings.file = juce::File();
+        audioProcessor.setImpulseResponse(settings);
+    });
+    menu.addSubMenu("Cabinet IR Length", lengthMenu);
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(this).withMousePosition());
+}
+
+void DISTROARAudioProcessorEditor::chooseImpulseResponseFile()
+{
+    const auto current = audioProcessor.getImpulseResponse().file;
+
+    impulseResponseChooser = std::make_unique<juce::FileChooser>("Load Cabinet IR",
+        current.existsAsFile() ? current : juce::File::getSpecialLocation(juce::File::userHomeDirectory),
+        "*.wav;*.aif;*.aiff;*.flac");
+
+    impulseResponseChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+        [this](const juce::FileChooser& chooser)
+        {
+            const auto file = chooser.getResult();
+
+            if (file.existsAsFile())
+            {
+                auto settings = audioProcessor.getImpulseResponse();
+                settings.file = file;
+                audioProcessor.setImpulseResponse(settings);
+            }
+        });
 }
 
 void DISTROARAudioProcessorEditor::mouseDown(const juce::MouseEvent& event)
 {
+    // Right-clicking the background opens the cabinet menu
+    if (event.eventComponent == this && event.mods.isPopupMenu())
+    {
+        showCabinetMenu();
+        return;
+    }
+
     if (event.eventComponent == &volumeSlider || event.eventComponent == &distortionSlider || event.eventComponent == &blendSlider || event.eventComponent == &toneSlider || event.eventComponent == &gateSlider)
     {
         // Store the initial mouse position
@@ -17,6 +17,9 @@ private:
     void mouseDown(const juce::MouseEvent& event) override;
     void mouseUp(const juce::MouseEvent& event) override;
     void buttonClicked(juce::Button* button) override;
+    void updateToggleButton(bool effectEnabled);
+    void showCabinetMenu();
+    void chooseImpulseResponseFile();
 
     juce::Slider volumeSlider;
     juce::Label volumeLabel;
@@ -34,13 +37,14 @@ private:
     juce::Label gateLabel;
 
     juce::ImageButton toggleButton;
-    bool effectEnabled;
+    juce::ParameterAttachment bypassAttachment; // Keeps the button in sync with host automation
 
     CustomLookAndFeel customLookAndFeel;
     juce::Image backgroundImage;
     juce::Image buttonOnImage;
     juce::Image buttonOffImage;
     juce::Point<int> initialMousePosition;
+    std::unique_ptr<juce::FileChooser> impulseResponseChooser;
 
     DISTROARAudioProcessor& audioProcessor;
 
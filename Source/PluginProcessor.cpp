@@ -1,5 +1,6 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "PluginState.h"
 
 //==============================================================================
 DISTROARAudioProcessor::DISTROARAudioProcessor()
@@ -19,17 +20,41 @@ DISTROARAudioProcessor::DISTROARAudioProcessor()
     addParameter(driveParameter = new juce::AudioParameterFloat("drive", "Drive", 0.0f, 1.0f, 0.5f));
     addParameter(toneParameter = new juce::AudioParameterFloat("tone", "Tone", 600.0f, 20000.0f, 10300.0f));
     addParameter(gateParameter = new juce::AudioParameterFloat("gate", "Gate", -90.0f, 0.0f, -80.0f));
+    addParameter(shaperModeParameter = new juce::AudioParameterChoice("shaperMode", "Shaper Mode", { "Direct", "Lookup Table" }, 0));
+    addParameter(oversamplingParameter = new juce::AudioParameterChoice("oversampling", "Oversampling", { "1x", "2x", "4x", "8x" }, 0));
+    addParameter(oversamplingFilterParameter = new juce::AudioParameterChoice("oversamplingFilter", "Oversampling Filter",
+                                                                              { "Minimum Latency (IIR)", "Linear Phase (FIR)" }, 0));
+    addParameter(gateLinkParameter = new juce::AudioParameterBool("gateLink", "Gate Stereo Link", true));
+    addParameter(antiAliasingParameter = new juce::AudioParameterChoice("antiAliasing", "Anti-Aliasing", { "Off", "ADAA 1st Order", "ADAA 2nd Order" }, 0));
+    addParameter(crossoverParameter = new juce::AudioParameterChoice("crossover", "Crossover", { "Minimum Phase (IIR)", "Linear Phase (FFT)" }, 0));
+    addParameter(lowCrossoverParameter = new juce::AudioParameterFloat("lowCrossover", "Low Crossover", DistroarEngine::Parameters::minLowCrossover,
+                                                                       DistroarEngine::Parameters::maxLowCrossover, 200.0f));
+    addParameter(highCrossoverParameter = new juce::AudioParameterFloat("highCrossover", "High Crossover", DistroarEngine::Parameters::minHighCrossover,
+                                                                        DistroarEngine::Parameters::maxHighCrossover, 2000.0f));
+    addParameter(bandsParameter = new juce::AudioParameterChoice("bands", "Bands", { "2", "3", "4", "5", "6" }, 1));
+
+    const auto defaultShapes = MultibandShaper::getDefaultShapes();
+
+    for (int band = 0; band < MultibandShaper::maxBands; ++band)
+    {
+        const auto id = "band" + juce::String(band + 1);
+        const auto name = "Band " + juce::String(band + 1);
+        const auto& shape = defaultShapes[(size_t)band];
+        auto& parameters = bandParameters[(size_t)band];
+
+        addParameter(parameters.drive = new juce::AudioParameterFloat(id + "Drive", name + " Drive", 0.0f, BandShape::maxDrive, shape.drive));
+        addParameter(parameters.clipLevel = new juce::AudioParameterFloat(id + "Clip", name + " Clip", BandShape::minClipLevel,
+                                                                          BandShape::maxClipLevel, shape.clipLevel));
+        addParameter(parameters.exponent = new juce::AudioParameterFloat(id + "Exponent", name + " Exponent", BandShape::minExponent,
+                                                                         BandShape::maxExponent, shape.exponent));
+    }
 
-    // Initialize crossover filters
-    lowPassFilter.setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
-    highPassFilter.setType(juce::dsp::LinkwitzRileyFilterType::highpass);
-
-	currentGainReduction = 1.0f;
-	smoothingFactor = 0.005f;
+    addParameter(bypassParameter = new juce::AudioParameterBool("bypass", "Bypass", false));
 }
 
 DISTROARAudioProcessor::~DISTROARAudioProcessor()
 {
+    cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -67,7 +92,7 @@ bool DISTROARAudioProcessor::isMidiEffect() const
 
 double DISTROARAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return engine.getTailLengthSeconds();
 }
 
 int DISTROARAudioProcessor::getNumPrograms()
@@ -97,62 +122,26 @@ void DISTROARAudioProcessor::changeProgramName(int index, const juce::String& ne
 //==============================================================================
 void DISTROARAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    // Use this method as the place to do any pre-playback
-    // initialisation that you need..
-
-    // Prepare crossover filters
-    lowPassFilter.prepare({ sampleRate, static_cast<juce::uint32>(samplesPerBlock), 2 });
-    highPassFilter.prepare({ sampleRate, static_cast<juce::uint32>(samplesPerBlock), 2 });
-
-    // Set crossover frequencies
-    lowPassFilter.setCutoffFrequency(200.0f); // Low band cutoff frequency
-    highPassFilter.setCutoffFrequency(2000.0f); // High band cutoff frequency
-
-    // Prepare buffers for each band
-    lowBandBuffer.setSize(2, samplesPerBlock);
-    midBandBuffer.setSize(2, samplesPerBlock);
-    highBandBuffer.setSize(2, samplesPerBlock);
-
-    // Prepare tone control low pass filter
-    toneLowPassFilter.setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
-    toneLowPassFilter.prepare({ sampleRate, static_cast<juce::uint32>(samplesPerBlock), 2 });
-    toneLowPassFilter.reset(); // Reset the filter to clear any previous state
-
-    // Initialize pre-distortion compressor
-    preDistortionCompressor.setThreshold(-20.0f); // Threshold in dB
-    preDistortionCompressor.setRatio(2.0f); // Ratio
-    preDistortionCompressor.setAttack(10.0f); // Attack time in ms
-    preDistortionCompressor.setRelease(100.0f); // Release time in ms
-
-    // Initialize post-distortion compressor
-    postDistortionCompressor.setThreshold(-10.0f); // Threshold in dB
-    postDistortionCompressor.setRatio(12.0f); // Ratio
-    postDistortionCompressor.setAttack(10.0f); // Attack time in ms
-    postDistortionCompressor.setRelease(80.0f); // Release time in ms
-
-    // Prepare compressors
-    preDistortionCompressor.prepare({ sampleRate, static_cast<juce::uint32>(samplesPerBlock), 2 });
-    postDistortionCompressor.prepare({ sampleRate, static_cast<juce::uint32>(samplesPerBlock), 2 });
-
-    // Initialize input gain
-    inputGain.prepare({ sampleRate, static_cast<juce::uint32>(samplesPerBlock), 2 });
-    inputGain.setGainDecibels(15.0f); // Apply a fixed gain boost
-
-    // Prepare low shelf filter
-    lowShelfFilter.prepare({ sampleRate, static_cast<juce::uint32>(samplesPerBlock), static_cast<juce::uint32>(getTotalNumOutputChannels()) });
-
-    auto lowShelfCoefficients = juce::dsp::IIR::Coefficients<float>::makeLowShelf(
-        sampleRate, 100.0f, 0.707f, juce::Decibels::decibelsToGain(-10.0f)
-    );
-
-    *lowShelfFilter.state = *lowShelfCoefficients;
+    // Start from the current parameter values so nothing ramps in on the first block
+    engine.setParameters(getEngineParameters());
+    engine.prepare(sampleRate, samplesPerBlock, juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels()),
+                   isUsingDoublePrecision() ? DistroarEngine::Precision::double_ : DistroarEngine::Precision::single);
 
+    latencySamples = engine.getLatencySamples();
+    setLatencySamples(latencySamples);
 }
 
 void DISTROARAudioProcessor::releaseResources()
 {
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
+    engine.release();
+}
+
+void DISTROARAudioProcessor::setNonRealtime(bool isNonRealtime) noexcept
+{
+    AudioProcessor::setNonRealtime(isNonRealtime);
+
+    // Offline bounces get the cabinet convolution computed inline, so they come out the same every time
+    engine.setNonRealtime(isNonRealtime);
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -181,12 +170,67 @@ bool DISTROARAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts)
 }
 #endif
 
-void DISTROARAudioProcessor::setEffectEnabled(bool enabled)
+juce::AudioProcessorParameter* DISTROARAudioProcessor::getBypassParameter() const
+{
+    return bypassParameter;
+}
+
+void DISTROARAudioProcessor::setImpulseResponse(const CabinetImpulseResponse::Settings& impulseResponse)
+{
+    if (impulseResponse == getImpulseResponse())
+        return;
+
+    engine.setImpulseResponse(impulseResponse);
+    updateHostDisplay(ChangeDetails().withNonParameterStateChanged(true));
+}
+
+const CabinetImpulseResponse::Settings& DISTROARAudioProcessor::getImpulseResponse() const noexcept
+{
+    return engine.getImpulseResponse();
+}
+
+DistroarEngine::Parameters DISTROARAudioProcessor::getEngineParameters() const
+{
+    DistroarEngine::Parameters parameters;
+    parameters.volume = volumeParameter->get();
+    parameters.blend = blendParameter->get();
+    parameters.drive = driveParameter->get();
+    parameters.tone = toneParameter->get();
+    parameters.gateThreshold = gateParameter->get();
+    parameters.lowCrossover = lowCrossoverParameter->get();
+    parameters.highCrossover = highCrossoverParameter->get();
+    parameters.gateLinked = gateLinkParameter->get();
+    parameters.useLookupTables = shaperModeParameter->getIndex() == 1;
+    parameters.oversamplingStages = oversamplingParameter->getIndex();
+    parameters.linearPhaseOversampling = oversamplingFilterParameter->getIndex() == 1;
+    parameters.antiAliasing = antiAliasingParameter->getIndex();
+    parameters.linearPhaseCrossover = crossoverParameter->getIndex() == 1;
+    parameters.numBands = MultibandShaper::minBands + bandsParameter->getIndex();
+
+    for (size_t band = 0; band < bandParameters.size(); ++band)
+        parameters.bandShapes[band] = { bandParameters[band].drive->get(), bandParameters[band].clipLevel->get(), bandParameters[band].exponent->get() };
+
+    parameters.bypassed = bypassParameter->get();
+    return parameters;
+}
+
+bool DISTROARAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+void DISTROARAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
 {
-    effectEnabled = enabled;
+    processSamples(buffer);
 }
 
-void DISTROARAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+void DISTROARAudioProcessor::processBlock(juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    processSamples(buffer);
+}
+
+template <typename SampleType>
+void DISTROARAudioProcessor::processSamples(juce::AudioBuffer<SampleType>& buffer)
 {
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels = getTotalNumInputChannels();
@@ -195,193 +239,26 @@ void DISTROARAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
-    if (effectEnabled) {
-        // Apply input gain boost
-        juce::dsp::AudioBlock<float> gainBlock(buffer);
-        juce::dsp::ProcessContextReplacing<float> gainContext(gainBlock);
-        inputGain.process(gainContext);
-
-        // Apply low shelf filter
-        juce::dsp::AudioBlock<float> block(buffer);
-        juce::dsp::ProcessContextReplacing<float> context(block);
-        lowShelfFilter.process(context);
-
-        // Apply gate effect before distortion
-        float gateThreshold = juce::Decibels::decibelsToGain(gateParameter->get());
-        float targetGainReduction = 0.0f;
-        float attackTime = 0.01f; // Attack time in seconds
-        float releaseTime = 0.1f; // Release time in seconds
-        float attackCoeff = std::exp(-1.0f / (attackTime * getSampleRate()));
-        float releaseCoeff = std::exp(-1.0f / (releaseTime * getSampleRate()));
-
-        for (int channel = 0; channel < totalNumInputChannels; ++channel)
-        {
-            auto* channelData = buffer.getWritePointer(channel);
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-            {
-                float absSample = std::abs(channelData[sample]);
-                if (absSample < gateThreshold)
-                    currentGainReduction = attackCoeff * currentGainReduction + (1.0f - attackCoeff) * targetGainReduction;
-                else
-                    currentGainReduction = releaseCoeff * currentGainReduction + (1.0f - releaseCoeff) * 1.0f;
-
-                channelData[sample] *= currentGainReduction;
-            }
-        }
-
-        // Apply pre-distortion compression
-        juce::dsp::AudioBlock<float> preCompBlock(buffer);
-        juce::dsp::ProcessContextReplacing<float> preCompContext(preCompBlock);
-        preDistortionCompressor.process(preCompContext);
-
-        // Store the signal after pre-distortion compression
-        juce::AudioBuffer<float> preDistortionCompressedBuffer;
-        preDistortionCompressedBuffer.makeCopyOf(buffer);
-
-        // Split the input into three bands
-        lowBandBuffer.makeCopyOf(buffer);
-        highBandBuffer.makeCopyOf(buffer);
-
-        juce::dsp::AudioBlock<float> lowBlock(lowBandBuffer);
-        juce::dsp::AudioBlock<float> highBlock(highBandBuffer);
-
-        juce::dsp::ProcessContextReplacing<float> lowContext(lowBlock);
-        juce::dsp::ProcessContextReplacing<float> highContext(highBlock);
-
-        lowPassFilter.process(lowContext);
-        highPassFilter.process(highContext);
-
-        midBandBuffer.makeCopyOf(buffer);
-        midBandBuffer.addFrom(0, 0, lowBandBuffer, 0, 0, buffer.getNumSamples(), -1.0f);
-        midBandBuffer.addFrom(1, 0, lowBandBuffer, 1, 0, buffer.getNumSamples(), -1.0f);
-        midBandBuffer.addFrom(0, 0, highBandBuffer, 0, 0, buffer.getNumSamples(), -1.0f);
-        midBandBuffer.addFrom(1, 0, highBandBuffer, 1, 0, buffer.getNumSamples(), -1.0f);
-
-        // Apply different distortion algorithms to each band
-        for (int channel = 0; channel < totalNumInputChannels; ++channel)
-        {
-            auto* lowBandData = lowBandBuffer.getWritePointer(channel);
-            auto* midBandData = midBandBuffer.getWritePointer(channel);
-            auto* highBandData = highBandBuffer.getWritePointer(channel);
-            auto* originalData = buffer.getWritePointer(channel);
-
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-            {
-                float drive = *driveParameter * 6.2f;
-                float inputSample = originalData[sample];
-
-                // Adaptive Gain Compensation for Sustain
-                float inputGainComp = 1.0f + (0.22f / (0.12f + std::abs(inputSample)));
-                float adaptiveDrive = drive * inputGainComp;
-
-                // LOW BAND
-                float lowSample = lowBandData[sample] * (1.0f + adaptiveDrive * 0.4f);
-                lowSample = juce::jlimit<float>(-0.32f, 0.32f, lowSample); // reduce excess low-end
-                lowSample = (lowSample > 0.0f ? std::pow(lowSample, 0.65f) : -std::pow(-lowSample, 0.65f));
-                lowSample *= 1.04f;
-
-                // MID BAND
-                float midSample = midBandData[sample] * (1.0f + adaptiveDrive * 1.15f);
-                midSample = juce::jlimit<float>(-0.32f, 0.32f, midSample);
-                midSample = (midSample > 0.0f ? std::pow(midSample, 1.25f) : -std::pow(-midSample, 1.25f));
-                midSample *= 1.18f;
-
-                // HIGH BAND
-                float highSample = highBandData[sample] * (1.0f + adaptiveDrive * 0.3f); // Lower drive in high end
-                highSample = juce::jlimit<float>(-0.18f, 0.18f, highSample); // Reduce harsh high peaks
-                highSample = (highSample > 0.0f ? std::pow(highSample, 1.2f) : -std::pow(-highSample, 1.2f)); // Softer clipping for smoothness
-                highSample *= 0.88f; // Slight roll-off to control fizz
-
-                // Dynamic Control
-                float dynamicSmoothing = 1.0f / (1.0f + std::abs(lowSample * 0.2f + midSample * 0.28f + highSample * 0.15f));
-                lowSample *= dynamicSmoothing * 1.05f;
-                midSample *= dynamicSmoothing * 1.08f;
-                highSample *= dynamicSmoothing * 1.03f;
-
-                // Hard Clipping
-                float finalSample = (lowSample * 0.85f) + (midSample * 1.2f) + (highSample * 0.98f); // Reduced high band
-                finalSample = juce::jlimit<float>(-0.7f, 0.7f, finalSample);
-                finalSample = finalSample > 0.0f ? std::pow(finalSample, 0.8f) : -std::pow(-finalSample, 0.8f); // smoother distortion
-
-                // FINAL EQ
-                float cabSim = juce::dsp::IIR::Coefficients<float>::makeHighPass(44100, 95) // Cut sub-bass
-                    ->getMagnitudeForFrequency(95, 44100) * finalSample;
-                cabSim = juce::dsp::IIR::Coefficients<float>::makeLowPass(44100, 6500) // Lower to remove more fizz
-                    ->getMagnitudeForFrequency(6500, 44100) * cabSim;
-                cabSim = juce::jlimit<float>(-0.65f, 0.65f, cabSim);
-                cabSim *= 1.02f; // Keep definition
-
-                // Assign modified samples back
-                lowBandData[sample] = lowSample;
-                midBandData[sample] = midSample;
-                highBandData[sample] = highSample;
-                originalData[sample] = (cabSim * 0.998f) + (originalData[sample] * 0.002f); // 99.8% wet
-            }
-        }
-
-
-
-
-        // Recombine the bands into the final output
-        buffer.makeCopyOf(lowBandBuffer);
-        buffer.addFrom(0, 0, midBandBuffer, 0, 0, buffer.getNumSamples());
-        buffer.addFrom(1, 0, midBandBuffer, 1, 0, buffer.getNumSamples());
-        buffer.addFrom(0, 0, highBandBuffer, 0, 0, buffer.getNumSamples());
-        buffer.addFrom(1, 0, highBandBuffer, 1, 0, buffer.getNumSamples());
-
-        // Mix the pre-distortion compressed signal and distorted signals based on the blend parameter
-        float blend = blendParameter->get();
-        for (int channel = 0; channel < totalNumInputChannels; ++channel)
-        {
-            auto* preCompData = preDistortionCompressedBuffer.getReadPointer(channel);
-            auto* distortedData = buffer.getWritePointer(channel);
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-            {
-                distortedData[sample] = (1.0f - blend) * preCompData[sample] + blend * distortedData[sample];
-            }
-        }
-
-        // Apply tone control using low pass filter
-        float toneFrequency = *toneParameter;
-        toneLowPassFilter.setCutoffFrequency(toneFrequency);
-
-        juce::dsp::AudioBlock<float> bufferBlock(buffer);
-        juce::dsp::ProcessContextReplacing<float> toneContext(bufferBlock);
-        toneLowPassFilter.process(toneContext);
-
-        // Apply post-distortion compression
-        juce::dsp::ProcessContextReplacing<float> postCompContext(bufferBlock);
-        postDistortionCompressor.process(postCompContext);
-
-        // Apply gate effect after distortion
-        for (int channel = 0; channel < totalNumInputChannels; ++channel)
-        {
-            auto* channelData = buffer.getWritePointer(channel);
-            for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-            {
-                float absSample = std::abs(channelData[sample]);
-                if (absSample < gateThreshold)
-                    currentGainReduction = attackCoeff * currentGainReduction + (1.0f - attackCoeff) * targetGainReduction;
-                else
-                    currentGainReduction = releaseCoeff * currentGainReduction + (1.0f - releaseCoeff) * 1.0f;
-
-                channelData[sample] *= currentGainReduction;
-            }
-        }
-
-        // Apply volume control
-        float volume = *volumeParameter;
-        for (int channel = 0; channel < totalNumOutputChannels; ++channel)
-        {
-            buffer.applyGain(channel, 0, buffer.getNumSamples(), volume);
-        }
-    }
-    else {
-        // Bypass the effect, just pass the clean signal
-    }
-}
+    // Parameters are read once per block, the engine smooths them from there.
+    // Bypassing crossfades to the input, delayed by the same latency.
+    engine.setParameters(getEngineParameters());
 
+    // Oversampling and the crossover change the latency. The host is told from the message
+    // thread, as its latency listeners are not meant to run on the audio thread.
+    const int latency = engine.getLatencySamples();
 
+    if (latencySamples.exchange(latency) != latency)
+        triggerAsyncUpdate();
+
+    // An idle engine has already zeroed the block, clearing marks it as silent for the host wrappers
+    if (engine.process(buffer.getArrayOfWritePointers(), buffer.getNumSamples()))
+        buffer.clear();
+}
+
+void DISTROARAudioProcessor::handleAsyncUpdate()
+{
+    setLatencySamples(latencySamples);
+}
 
 //==============================================================================
 bool DISTROARAudioProcessor::hasEditor() const
@@ -397,15 +274,17 @@ juce::AudioProcessorEditor* DISTROARAudioProcessor::createEditor()
 //==============================================================================
 void DISTROARAudioProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    PluginState::save(*this, getImpulseResponse(), destData);
 }
 
 void DISTROARAudioProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    auto impulseResponse = getImpulseResponse();
+
+    // Restoring a state is not a change to report back to the host, which would mark
+    // the project as modified or add an undo step for every preset it scans
+    if (PluginState::load(*this, impulseResponse, data, sizeInBytes) && impulseResponse != getImpulseResponse())
+        engine.setImpulseResponse(impulseResponse);
 }
 
 //==============================================================================
@@ -1,11 +1,13 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "DistroarEngine.h"
 
 //==============================================================================
 /**
 */
-class DISTROARAudioProcessor : public juce::AudioProcessor
+class DISTROARAudioProcessor : public juce::AudioProcessor,
+                               private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -15,12 +17,15 @@ public:
     //==============================================================================
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
+    void setNonRealtime(bool isNonRealtime) noexcept override;
 
 #ifndef JucePlugin_PreferredChannelConfigurations
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
 #endif
 
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -45,28 +50,51 @@ public:
     void getStateInformation(juce::MemoryBlock& destData) override;
     void setStateInformation(const void* data, int sizeInBytes) override;
 
-    void setEffectEnabled(bool enabled);
-    bool effectEnabled;
+    juce::AudioProcessorParameter* getBypassParameter() const override;
+
+    /** The cabinet impulse response, which is saved with the state rather than being a parameter.
+        Setting a different one tells the host the state has changed.
+    */
+    void setImpulseResponse(const CabinetImpulseResponse::Settings& impulseResponse);
+    const CabinetImpulseResponse::Settings& getImpulseResponse() const noexcept;
+
     double distortionAmount;
     juce::AudioParameterFloat* volumeParameter;
     juce::AudioParameterFloat* blendParameter;
     juce::AudioParameterFloat* driveParameter;
     juce::AudioParameterFloat* toneParameter;
     juce::AudioParameterFloat* gateParameter;
-    float currentGainReduction;
-    float smoothingFactor;
+    juce::AudioParameterFloat* lowCrossoverParameter;
+    juce::AudioParameterFloat* highCrossoverParameter;
+    juce::AudioParameterChoice* shaperModeParameter;
+    juce::AudioParameterChoice* oversamplingParameter;
+    juce::AudioParameterChoice* oversamplingFilterParameter;
+    juce::AudioParameterChoice* antiAliasingParameter;
+    juce::AudioParameterChoice* crossoverParameter;
+    juce::AudioParameterChoice* bandsParameter;
+    juce::AudioParameterBool* gateLinkParameter;
+    juce::AudioParameterBool* bypassParameter;
+
+    struct BandParameters
+    {
+        juce::AudioParameterFloat* drive;
+        juce::AudioParameterFloat* clipLevel;
+        juce::AudioParameterFloat* exponent;
+    };
+
+    std::array<BandParameters, MultibandShaper::maxBands> bandParameters;
 
 private:
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DISTROARAudioProcessor)
-    juce::dsp::LinkwitzRileyFilter<float> lowPassFilter;
-    juce::dsp::LinkwitzRileyFilter<float> highPassFilter;
-    juce::AudioBuffer<float> lowBandBuffer;
-    juce::AudioBuffer<float> midBandBuffer;
-    juce::AudioBuffer<float> highBandBuffer;
-    juce::dsp::LinkwitzRileyFilter<float> toneLowPassFilter;
-    juce::dsp::Compressor<float> preDistortionCompressor;
-    juce::dsp::Compressor<float> postDistortionCompressor;
-    juce::dsp::Gain<float> inputGain;
-    juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> lowShelfFilter;
+
+    DistroarEngine::Parameters getEngineParameters() const;
+
+    template <typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer);
+
+    void handleAsyncUpdate() override;
+
+    DistroarEngine engine;
+    std::atomic<int> latencySamples { 0 };  // Reported to the host from the message thread
 };
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "PluginState.h"
+
+namespace
+{
+    const juce::int32 stateMagic = (juce::int32)juce::ByteOrder::littleEndianInt("DSTA");
+    const juce::int32 parametersChunkId = (juce::int32)juce::ByteOrder::littleEndianInt("PARM");
+    const juce::int32 impulseResponseChunkId = (juce::int32)juce::ByteOrder::littleEndianInt("CABI");
+
+    juce::String getParameterId(const juce::AudioProcessorParameter& parameter)
+    {
+        if (auto* hosted = dynamic_cast<const juce::HostedAudioProcessorParameter*>(&parameter))
+            return hosted->getParameterID();
+
+        return {};
+    }
+}
+
+void PluginState::writeChunk(juce::OutputStream& stream, juce::int32 chunkId, const juce::MemoryOutputStream& chunk)
+{
+    stream.writeInt(chunkId);
+    stream.writeInt((int)chunk.getDataSize());
+    stream.write(chunk.getData(), chunk.getDataSize());
+}
+
+void PluginState::save(const juce::AudioProcessor& processor, const CabinetImpulseResponse::Settings& impulseResponse,
+                       juce::MemoryBlock& destData)
+{
+    juce::MemoryOutputStream parameters;
+    juce::Array<juce::AudioProcessorParameter*> savedParameters;
+
+    for (auto* parameter : processor.getParameters())
+        if (getParameterId(*parameter).isNotEmpty())
+            savedParameters.add(parameter);
+
+    parameters.writeInt(savedParameters.size());
+
+    for (auto* parameter : savedParameters)
+    {
+        parameters.writeString(getParameterId(*parameter));
+        parameters.writeFloat(parameter->getValue());
+    }
+
+    juce::MemoryOutputStream cabinet;
+    cabinet.writeString(impulseResponse.file.getFullPathName());
+    cabinet.writeDouble(impulseResponse.lengthLimitSeconds);
+
+    juce::MemoryOutputStream stream(destData, false);
+    stream.writeInt(stateMagic);
+    stream.writeInt(formatVersion);
+    writeChunk(stream, parametersChunkId, parameters);
+    writeChunk(stream, impulseResponseChunkId, cabinet);
+}
+
+bool PluginState::load(juce::AudioProcessor& processor, CabinetImpulseResponse::Settings& impulseResponse,
+                       const void* data, int sizeInBytes)
+{
+    if (data == nullptr || sizeInBytes < 8)
+        return false;
+
+    juce::MemoryInputStream stream(data, (size_t)sizeInBytes, false);
+
+    if (stream.readInt() != stateMagic)
+        return false;
+
+    const int version = stream.readInt();
+    if (version < 1 || version > formatVersion)
+        return false;
+
+    // Read everything before changing anything, so a damaged state leaves the plugin as it was
+    struct ParameterValue
+    {
+        juce::AudioProcessorParameter* parameter;
+        float value;
+    };
+
+    juce::Array<ParameterValue> values;
+    const auto& parameters = processor.getParameters();
+    auto loadedImpulseResponse = impulseResponse;
+
+    while (stream.getNumBytesRemaining() >= 8)
+    {
+        const auto chunkId = stream.readInt();
+        const auto chunkSize = stream.readInt();
+
+        if (chunkSize < 0 || chunkSize > stream.getNumBytesRemaining())
+            return false;
+
+        juce::MemoryInputStream chunk(static_cast<const char*>(data) + stream.getPosition(), (size_t)chunkSize, false);
+        stream.skipNextBytes(chunkSize);
+
+        if (chunkId == parametersChunkId)
+        {
+            const int numParameters = chunk.readInt();
+
+            for (int i = 0; i < numParameters && ! chunk.isExhausted(); ++i)
+            {
+                const auto id = chunk.readString();
+                const float value = chunk.readFloat();
+
+                for (auto* parameter : parameters)
+                {
+                    if (getParameterId(*parameter) == id)
+                    {
+                        values.add({ parameter, juce::jlimit(0.0f, 1.0f, value) });
+                        break;
+                    }
+                }
+            }
+        }
+        else if (chunkId == impulseResponseChunkId)
+        {
+            // Only absolute paths are saved; anything else means no impulse response
+            const auto path = chunk.readString();
+            loadedImpulseResponse.file = juce::File::isAbsolutePath(path) ? juce::File(path) : juce::File();
+            loadedImpulseResponse.lengthLimitSeconds = chunk.readDouble();
+        }
+    }
+
+    for (auto& entry : values)
+        if (entry.parameter->getValue() != entry.value)
+            entry.parameter->setValueNotifyingHost(entry.value);
+
+    impulseResponse = loadedImpulseResponse;
+    return true;
+}
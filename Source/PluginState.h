@@ -0,0 +1,40 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "CabinetImpulseResponse.h"
+
+//==============================================================================
+/**
+    Binary save and restore of the plugin state.
+
+    A state is a magic number and a format version, followed by tagged chunks
+    that each start with their size:
+
+        'PARM'  number of parameters, then the ID and normalised value of each
+        'CABI'  cabinet impulse response file path and length limit in seconds
+
+    Readers skip chunks they do not know, so new settings are added as new
+    chunks and older sessions keep loading. The version only changes when an
+    existing chunk changes meaning; newer versions are refused.
+
+    Loading only touches parameters whose value actually changes. Parameters
+    are picked up by the engine on the next block, so nothing is re-prepared.
+*/
+class PluginState
+{
+public:
+    static constexpr int formatVersion = 1;
+
+    /** Writes the state of every parameter of the processor and the cabinet impulse response. */
+    static void save(const juce::AudioProcessor& processor, const CabinetImpulseResponse::Settings& impulseResponse,
+                     juce::MemoryBlock& destData);
+
+    /** Restores the parameters found in data. Parameters missing from it keep their values, and so
+        does impulseResponse if data has none. Returns false and changes nothing if data is not a valid state.
+    */
+    static bool load(juce::AudioProcessor& processor, CabinetImpulseResponse::Settings& impulseResponse,
+                     const void* data, int sizeInBytes);
+
+private:
+    static void writeChunk(juce::OutputStream& stream, juce::int32 chunkId, const juce::MemoryOutputStream& chunk);
+};
@@ -0,0 +1,758 @@
+#include "ProcessingChain.h"
+#include "AllocationGuard.h"
+#include "MultibandShaper.h"
+
+namespace
+{
+    constexpr float lowShelfFrequency = 100.0f;
+    constexpr float lowShelfQ = 0.707f;
+    constexpr float inputGainDecibels = 15.0f;      // Fixed boost ahead of the low shelf
+    constexpr float lowestToneFrequency = 600.0f;   // Bottom of the tone control's range
+    constexpr float preDistortionRelease = 100.0f;  // ms
+    constexpr float postDistortionRelease = 80.0f;  // ms
+
+    // Input, filter and envelope levels below this count as silence
+    constexpr double silenceDecibels = -120.0;
+
+    /** Seconds for a second order section to ring down by silenceDecibels. Its poles decay as exp(-t * 2 pi f / 2Q). */
+    double getRingDownSeconds(double frequency, double q)
+    {
+        return -silenceDecibels / 20.0 * std::log(10.0) * 2.0 * q / (juce::MathConstants<double>::twoPi * frequency);
+    }
+
+    /** Seconds for a one pole envelope with the given time constant to fall by silenceDecibels. */
+    double getEnvelopeDecaySeconds(double timeConstant)
+    {
+        return -silenceDecibels / 20.0 * std::log(10.0) * timeConstant;
+    }
+
+    /** How long the output keeps ringing once the input goes silent, not counting latency.
+        Summing the filters in series is a safe upper bound.
+    */
+    double getTailSeconds()
+    {
+        constexpr double butterworthQ = 0.7071;
+
+        return getRingDownSeconds(lowShelfFrequency, lowShelfQ)
+             + 2.0 * getRingDownSeconds(ChainParameters::minLowCrossover, butterworthQ)   // Linkwitz-Riley, two Butterworth sections
+             + 2.0 * getRingDownSeconds(ChainParameters::minHighCrossover, butterworthQ)
+             + getRingDownSeconds(CabSimulator<float>::highPassFrequency, butterworthQ)
+             + 2.0 * getRingDownSeconds(lowestToneFrequency, butterworthQ);
+    }
+
+    /** How long until every filter, compressor and gate state has decayed once the input goes silent. */
+    double getSettlingSeconds()
+    {
+        // JUCE's compressor envelope uses a time constant of release / 2 pi
+        const double compressorSeconds = getEnvelopeDecaySeconds(juce::jmax(preDistortionRelease, postDistortionRelease)
+                                                                 / 1000.0 / juce::MathConstants<double>::twoPi);
+        const double gateSeconds = getEnvelopeDecaySeconds(NoiseGate<float>::attackTime);
+
+        return juce::jmax(getTailSeconds(), compressorSeconds, gateSeconds);
+    }
+
+    WaveshaperTableSet::Curves getDefaultCurves()
+    {
+        const ChainParameters defaults;
+        return MultibandShaper::getCurves(MultibandShaper::makeLayout(defaults.numBands, defaults.bandShapes));
+    }
+}
+
+template <typename SampleType, int NumChannels>
+FixedChannelChain<SampleType, NumChannels>::FixedChannelChain()
+    : requestedTableCurves(getDefaultCurves()), waveshaperTables(requestedTableCurves)
+{
+}
+
+template <typename SampleType, int NumChannels>
+void FixedChannelChain<SampleType, NumChannels>::prepare(double newSampleRate, int maxBlockSize, const ChainParameters& initialParameters)
+{
+    sampleRate = newSampleRate;
+    setParameters(initialParameters);
+
+    // Everything below only ever sees one sub-block at a time
+    const int maxSubBlockSize = juce::jmin(maxBlockSize, subBlockSize);
+
+    // Prepare crossover filters, the band count and split frequencies are set by updateBandLayout() below
+    crossoverTree.prepare({ sampleRate, static_cast<juce::uint32>(maxSubBlockSize), static_cast<juce::uint32>(numChannels) });
+
+    // The linear-phase alternative is always prepared, so switching to it never allocates
+    float splitFrequencies[maxBands - 1];
+    CrossoverTree<SampleType>::getSplitFrequencies(parameters.lowCrossover, parameters.highCrossover, parameters.numBands, splitFrequencies);
+    linearPhaseCrossover.prepare(sampleRate, numChannels, splitFrequencies, parameters.numBands);
+    activeLinearPhaseCrossover = parameters.linearPhaseCrossover;
+
+    // Allocate all scratch buffers up front, each slot holds one sub-block
+    scratchArena.prepare(numArenaSlots, numChannels, maxSubBlockSize);
+
+    // Prepare tone control low pass filter
+    toneLowPassFilter.setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
+    toneLowPassFilter.prepare({ sampleRate, static_cast<juce::uint32>(maxSubBlockSize), static_cast<juce::uint32>(numChannels) });
+    toneLowPassFilter.reset(); // Reset the filter to clear any previous state
+
+    // Initialize pre-distortion compressor
+    preDistortionCompressor.setThreshold(-20.0f); // Threshold in dB
+    preDistortionCompressor.setRatio(2.0f); // Ratio
+    preDistortionCompressor.setAttack(10.0f); // Attack time in ms
+    preDistortionCompressor.setRelease(preDistortionRelease); // Release time in ms
+
+    // Initialize post-distortion compressor
+    postDistortionCompressor.setThreshold(-10.0f); // Threshold in dB
+    postDistortionCompressor.setRatio(12.0f); // Ratio
+    postDistortionCompressor.setAttack(10.0f); // Attack time in ms
+    postDistortionCompressor.setRelease(postDistortionRelease); // Release time in ms
+
+    // Prepare compressors
+    preDistortionCompressor.prepare({ sampleRate, static_cast<juce::uint32>(maxSubBlockSize), static_cast<juce::uint32>(numChannels) });
+    postDistortionCompressor.prepare({ sampleRate, static_cast<juce::uint32>(maxSubBlockSize), static_cast<juce::uint32>(numChannels) });
+
+    // Prepare low shelf filter, with the input gain boost folded into its feed-forward coefficients
+    auto lowShelfCoefficients = juce::dsp::IIR::Coefficients<SampleType>::makeLowShelf(
+        sampleRate, lowShelfFrequency, lowShelfQ, juce::Decibels::decibelsToGain(-10.0f)
+    );
+
+    for (int i = 0; i < 3; ++i)
+        lowShelfCoefficients->coefficients.getReference(i) *= juce::Decibels::decibelsToGain((SampleType)inputGainDecibels);
+
+    for (auto& filter : lowShelfFilters)
+    {
+        filter.coefficients = lowShelfCoefficients;
+        filter.prepare({ sampleRate, static_cast<juce::uint32>(maxSubBlockSize), 1 });
+    }
+
+    // Prepare cab sim for the processing sample rate
+    cabSimulator.prepare({ sampleRate, static_cast<juce::uint32>(maxSubBlockSize), static_cast<juce::uint32>(numChannels) });
+    cabinetImpulseResponse.prepare({ sampleRate, static_cast<juce::uint32>(maxSubBlockSize), static_cast<juce::uint32>(numChannels) });
+
+    // Prepare every oversampler up front so switching band count, factor or filter never allocates.
+    // Each one runs the dry and used band slots of the arena as a single block; sizing them per
+    // band count keeps the later stages from filtering the unused slots.
+    oversamplers.clear();
+    activeOversampler = nullptr;
+    activeOversamplingChoice = -1;
+
+    for (int numBands = MultibandShaper::minBands; numBands <= maxBands; ++numBands)
+    {
+        for (auto filterType : { juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR,
+                                 juce::dsp::Oversampling<SampleType>::filterHalfBandFIREquiripple })
+        {
+            for (int stages = 1; stages <= maxOversamplingStages; ++stages)
+            {
+                auto* oversampler = oversamplers.add(new juce::dsp::Oversampling<SampleType>(
+                    (size_t)((1 + numBands) * numChannels), (size_t)stages, filterType, true, true));
+                oversampler->initProcessing((size_t)maxSubBlockSize);
+            }
+        }
+    }
+
+    // Parameter smoothing, starting from the current values so nothing ramps in on the first block
+    driveRamp.prepare(sampleRate, parameterRampSeconds, maxSubBlockSize << maxOversamplingStages, parameters.drive);
+    blendRamp.prepare(sampleRate, parameterRampSeconds, maxSubBlockSize, parameters.blend);
+    volumeRamp.prepare(sampleRate, parameterRampSeconds, maxSubBlockSize, parameters.volume);
+    toneRamp.prepare(sampleRate, parameterRampSeconds, maxSubBlockSize, parameters.tone);
+    lowCrossoverRamp.prepare(sampleRate, parameterRampSeconds, maxSubBlockSize, parameters.lowCrossover);
+    highCrossoverRamp.prepare(sampleRate, parameterRampSeconds, maxSubBlockSize, parameters.highCrossover);
+
+    updateOversampling();
+
+    // The bypass path is delayed to match the largest latency any setting can have
+    maxLatencySamples = 0;
+
+    for (auto* oversampler : oversamplers)
+        maxLatencySamples = juce::jmax(maxLatencySamples, (int)std::ceil(oversampler->getLatencyInSamples()));
+
+    maxLatencySamples += linearPhaseCrossover.getLatencySamples();
+    bypassDelay.prepare(numChannels, maxLatencySamples, maxSubBlockSize);
+    bypassRamp.prepare(sampleRate, bypassFadeSeconds, maxSubBlockSize, parameters.bypassed ? 1.0f : 0.0f);
+    impulseResponseRamp.prepare(sampleRate, parameterRampSeconds, maxSubBlockSize, cabinetImpulseResponse.isLoaded() ? 1.0f : 0.0f);
+    fullyBypassed = parameters.bypassed;
+
+    // Prepare anti-derivative anti-aliasing state
+    adaaShaper.prepare(numChannels);
+
+    // Start the crossover and shapers on the current band layout
+    activeNumBands = 0;
+    updateBandLayout();
+
+    // The double chain hands the shapers float copies of one channel's input and bands at a time,
+    // and reuses the memory for the convolution's two slots once shaping is done
+    maxShapingSamples = maxSubBlockSize << maxOversamplingStages;
+    static_assert(numShapingSlots >= 2 * numChannels);
+
+    if constexpr (std::is_same_v<SampleType, double>)
+        floatShapingScratch.allocate((size_t)(numShapingSlots * maxShapingSamples), true);
+
+    // Prepare the gates before and after distortion
+    preDistortionGate.prepare({ sampleRate, static_cast<juce::uint32>(maxSubBlockSize), static_cast<juce::uint32>(numChannels) });
+    postDistortionGate.prepare({ sampleRate, static_cast<juce::uint32>(maxSubBlockSize), static_cast<juce::uint32>(numChannels) });
+
+    // Silent input is only skipped once every state has had time to decay
+    silenceThreshold = (SampleType)juce::Decibels::decibelsToGain(silenceDecibels, silenceDecibels - 1.0);
+    settlingSamples = (int)std::ceil(getSettlingSeconds() * sampleRate);
+    silentInputSamples = 0;
+}
+
+template <typename SampleType, int NumChannels>
+void FixedChannelChain<SampleType, NumChannels>::release()
+{
+    scratchArena.release();
+    floatShapingScratch.free();
+    maxShapingSamples = 0;
+}
+
+template <typename SampleType, int NumChannels>
+void FixedChannelChain<SampleType, NumChannels>::setParameters(const ChainParameters& newParameters) noexcept
+{
+    parameters = newParameters;
+    parameters.lowCrossover = juce::jlimit(ChainParameters::minLowCrossover, ChainParameters::maxLowCrossover, parameters.lowCrossover);
+    parameters.highCrossover = juce::jlimit(ChainParameters::minHighCrossover, ChainParameters::maxHighCrossover, parameters.highCrossover);
+    parameters.numBands = juce::jlimit(MultibandShaper::minBands, maxBands, parameters.numBands);
+
+    for (auto& shape : parameters.bandShapes)
+    {
+        shape.drive = juce::jlimit(0.0f, BandShape::maxDrive, shape.drive);
+        shape.clipLevel = juce::jlimit(BandShape::minClipLevel, BandShape::maxClipLevel, shape.clipLevel);
+        shape.exponent = juce::jlimit(BandShape::minExponent, BandShape::maxExponent, shape.exponent);
+    }
+
+    preDistortionGate.setThresholdDecibels(parameters.gateThreshold);
+    preDistortionGate.setStereoLinked(parameters.gateLinked);
+    postDistortionGate.setThresholdDecibels(parameters.gateThreshold);
+    postDistortionGate.setStereoLinked(parameters.gateLinked);
+}
+
+template <typename SampleType, int NumChannels>
+void FixedChannelChain<SampleType, NumChannels>::loadImpulseResponse(const CabinetImpulseResponse::Settings& settings)
+{
+    cabinetImpulseResponse.load(settings);
+}
+
+template <typename SampleType, int NumChannels>
+void FixedChannelChain<SampleType, NumChannels>::setNonRealtime(bool isNonRealtime)
+{
+    cabinetImpulseResponse.setNonRealtime(isNonRealtime);
+}
+
+template <typename SampleType, int NumChannels>
+juce::dsp::Oversampling<SampleType>* FixedChannelChain<SampleType, NumChannels>::getOversampler(const ChainParameters& settings) const noexcept
+{
+    const int stages = juce::jlimit(0, maxOversamplingStages, settings.oversamplingStages);
+
+    if (stages == 0)
+        return nullptr;
+
+    const int numBands = juce::jlimit(MultibandShaper::minBands, maxBands, settings.numBands);
+    return oversamplers[((numBands - MultibandShaper::minBands) * 2 + (settings.linearPhaseOversampling ? 1 : 0)) * maxOversamplingStages
+                        + stages - 1];
+}
+
+template <typename SampleType, int NumChannels>
+int FixedChannelChain<SampleType, NumChannels>::getLatencySamples() const noexcept
+{
+    auto* oversampler = getOversampler(parameters);
+    const int oversamplingLatency = oversampler != nullptr ? juce::roundToInt(oversampler->getLatencyInSamples()) : 0;
+
+    return oversamplingLatency + (parameters.linearPhaseCrossover ? linearPhaseCrossover.getLatencySamples() : 0);
+}
+
+template <typename SampleType, int NumChannels>
+void FixedChannelChain<SampleType, NumChannels>::updateOversampling()
+{
+    const int choice = ((parameters.numBands - MultibandShaper::minBands) * 2 + (parameters.linearPhaseOversampling ? 1 : 0))
+                         * (maxOversamplingStages + 1)
+                     + juce::jlimit(0, maxOversamplingStages, parameters.oversamplingStages);
+
+    if (choice == activeOversamplingChoice)
+        return;
+
+    activeOversamplingChoice = choice;
+    activeOversampler = getOversampler(parameters);
+
+    if (activeOversampler != nullptr)
+        activeOversampler->reset();
+
+    driveRamp.setSampleRate(sampleRate * (double)(1 << juce::jlimit(0, maxOversamplingStages, parameters.oversamplingStages)));
+}
+
+template <typename SampleType, int NumChannels>
+void FixedChannelChain<SampleType, NumChannels>::shapeBands(int channel, SampleType* const* bands, const SampleType* input,
+                                             int numSamples, float drive, const float* driveValues)
+{
+    if constexpr (std::is_same_v<SampleType, float>)
+    {
+        shapeFloatBands(channel, bands, input, numSamples, drive, driveValues);
+    }
+    else
+    {
+        jassert(numSamples <= maxShapingSamples);
+
+        float* floatInput = floatShapingScratch.get();
+        float* floatBands[maxBands];
+
+        for (int sample = 0; sample < numSamples; ++sample)
+            floatInput[sample] = (float)input[sample];
+
+        for (int band = 0; band < activeNumBands; ++band)
+        {
+            floatBands[band] = floatInput + (1 + band) * maxShapingSamples;
+
+            for (int sample = 0; sample < numSamples; ++sample)
+                floatBands[band][sample] = (float)bands[band][sample];
+        }
+
+        shapeFloatBands(channel, floatBands, floatInput, numSamples, drive, driveValues);
+
+        for (int band = 0; band < activeNumBands; ++band)
+            for (int sample = 0; sample < numSamples; ++sample)
+                bands[band][sample] = (SampleType)floatBands[band][sample];
+    }
+}
+
+template <typename SampleType, int NumChannels>
+void FixedChannelChain<SampleType, NumChannels>::shapeFloatBands(int channel, float* const* bands, const float* input,
+                                                  int numSamples, float drive, const float* driveValues)
+{
+    // ADAA replaces the direct or table shapers when enabled
+    if (activeAntiAliasing > 0)
+        adaaShaper.process(channel, bands, input, numSamples, drive, driveValues,
+                           activeAntiAliasing == 1 ? AdaaShaper::Order::first : AdaaShaper::Order::second);
+    else if (parameters.useLookupTables)
+        MultibandShaper::processWithTables(bands, input, numSamples, drive, driveValues, bandLayout, waveshaperTables.getTables());
+    else
+        MultibandShaper::process(bands, input, numSamples, drive, driveValues, bandLayout);
+}
+
+template <typename SampleType, int NumChannels>
+bool FixedChannelChain<SampleType, NumChannels>::process(SampleType* const* channels, int numSamples) noexcept
+{
+    juce::ScopedNoDenormals noDenormals;
+    const ScopedAudioThreadAllocationCheck allocationCheck;
+
+    // Blocks are processed in arena-sized sub-blocks, whatever the host's block size
+    const int maxChunkSize = scratchArena.getMaxSamples();
+    jassert(maxChunkSize > 0); // prepare() has not been called
+    if (maxChunkSize == 0)
+        return false;
+
+    updateBandLayout();
+    updateOversampling();
+
+    // After enough silence the chain's output is silent as well, so idle blocks are just cleared
+    if (isSilent(channels, numSamples))
+    {
+        if (silentInputSamples >= settlingSamples + cabinetImpulseResponse.getLengthSamples() + getLatencySamples())
+        {
+            skipIdleBlock(channels, numSamples);
+            return true;
+        }
+
+        silentInputSamples += numSamples;
+    }
+    else
+    {
+        silentInputSamples = 0;
+    }
+
+    const int latency = getLatencySamples();
+
+    for (int startSample = 0; startSample < numSamples; startSample += maxChunkSize)
+    {
+        const int numChunkSamples = juce::jmin(maxChunkSize, numSamples - startSample);
+        SampleType* chunk[numChannels];
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            chunk[channel] = channels[channel] + startSample;
+
+        // Keep a copy of the input in line with the processed signal for bypassing
+        auto* const* bypassChannels = scratchArena.getChannels(bypassScratch);
+        bypassDelay.process(chunk, bypassChannels, numChunkSamples, latency);
+
+        bypassRamp.advance(parameters.bypassed ? 1.0f : 0.0f, numChunkSamples);
+        const float* bypassValues = bypassRamp.getRamp();
+
+        if (bypassValues == nullptr && bypassRamp.getCurrentValue() >= 1.0f)
+        {
+            // Fully bypassed, the delayed input is the whole output
+            for (int channel = 0; channel < numChannels; ++channel)
+                juce::FloatVectorOperations::copy(chunk[channel], bypassChannels[channel], numChunkSamples);
+
+            fullyBypassed = true;
+            continue;
+        }
+
+        // Fade back in from a clean chain rather than from the state it stopped in
+        if (fullyBypassed)
+        {
+            resetState();
+            fullyBypassed = false;
+        }
+
+        processChunk(chunk, numChunkSamples);
+
+        if (bypassValues != nullptr)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* data = chunk[channel];
+                const auto* dryData = bypassChannels[channel];
+
+                for (int sample = 0; sample < numChunkSamples; ++sample)
+                    data[sample] += (SampleType)bypassValues[sample] * (dryData[sample] - data[sample]);
+            }
+        }
+    }
+
+    return false;
+}
+
+template <typename SampleType, int NumChannels>
+void FixedChannelChain<SampleType, NumChannels>::resetState() noexcept
+{
+    crossoverTree.reset();
+    linearPhaseCrossover.reset();
+    toneLowPassFilter.reset();
+    preDistortionCompressor.reset();
+    postDistortionCompressor.reset();
+
+    for (auto& filter : lowShelfFilters)
+        filter.reset();
+
+    cabSimulator.reset();
+    cabinetImpulseResponse.reset();
+    adaaShaper.reset();
+    preDistortionGate.reset();
+    postDistortionGate.reset();
+
+    if (activeOversampler != nullptr)
+        activeOversampler->reset();
+}
+
+template <typename SampleType, int NumChannels>
+bool FixedChannelChain<SampleType, NumChannels>::isSilent(SampleType* const* channels, int numSamples) const noexcept
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto range = juce::FloatVectorOperations::findMinAndMax(channels[channel], numSamples);
+
+        if (range.getStart() < -silenceThreshold || range.getEnd() > silenceThreshold)
+            return false;
+    }
+
+    return true;
+}
+
+template <typename SampleType, int NumChannels>
+void FixedChannelChain<SampleType, NumChannels>::skipIdleBlock(SampleType* const* channels, int numSamples) noexcept
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+        juce::FloatVectorOperations::clear(channels[channel], numSamples);
+
+    // Keep the smoothed parameters moving so they are where they should be when the input returns
+    const int oversamplingFactor = activeOversampler != nullptr ? (int)activeOversampler->getOversamplingFactor() : 1;
+
+    driveRamp.skip(parameters.drive, numSamples * oversamplingFactor);
+    blendRamp.skip(parameters.blend, numSamples);
+    volumeRamp.skip(parameters.volume, numSamples);
+    toneRamp.skip(parameters.tone, numSamples);
+    lowCrossoverRamp.skip(parameters.lowCrossover, numSamples);
+    highCrossoverRamp.skip(parameters.highCrossover, numSamples);
+
+    float splitFrequencies[maxBands - 1];
+    getSplitFrequencies(splitFrequencies);
+    crossoverTree.setSplitFrequencies(splitFrequencies);
+    linearPhaseCrossover.setFrequencies(splitFrequencies, activeNumBands);
+    bypassRamp.skip(parameters.bypassed ? 1.0f : 0.0f, numSamples);
+    impulseResponseRamp.skip(cabinetImpulseResponse.isLoaded() ? 1.0f : 0.0f, numSamples);
+}
+
+template <typename SampleType, int NumChannels>
+void FixedChannelChain<SampleType, NumChannels>::processChunk(SampleType* const* channels, int numSamples)
+{
+    // Input gain, low shelf, gate, pre-distortion compression and the band split
+    processInputStages(channels, numSamples);
+
+    // Apply different distortion algorithms to each band, oversampling only this stage
+    // Start the ADAA state clean whenever it is switched
+    const int antiAliasing = parameters.antiAliasing;
+    if (antiAliasing != activeAntiAliasing)
+    {
+        activeAntiAliasing = antiAliasing;
+        adaaShaper.reset();
+    }
+
+    juce::dsp::AudioBlock<SampleType> shapingBlock(scratchArena.getChannels(dryScratch), (size_t)((1 + activeNumBands) * numChannels), (size_t)numSamples);
+    auto oversampledBlock = activeOversampler != nullptr ? activeOversampler->processSamplesUp(shapingBlock) : shapingBlock;
+    const int numOversampledSamples = (int)oversampledBlock.getNumSamples();
+
+    driveRamp.advance(parameters.drive, numOversampledSamples);
+    const float drive = driveRamp.getCurrentValue();
+    const float* driveValues = driveRamp.getRamp();
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* originalData = oversampledBlock.getChannelPointer((size_t)channel);
+        SampleType* bandData[maxBands];
+
+        for (int band = 0; band < activeNumBands; ++band)
+            bandData[band] = oversampledBlock.getChannelPointer((size_t)((1 + band) * numChannels + channel));
+
+        shapeBands(channel, bandData, originalData, numOversampledSamples, drive, driveValues);
+    }
+
+    // Downsampling also delays the dry copy, so the blend below stays time aligned
+    if (activeOversampler != nullptr)
+        activeOversampler->processSamplesDown(shapingBlock);
+
+    // Recombination, cab sim, blend, tone, post-distortion compression, gate and volume
+    processOutputStages(channels, numSamples);
+}
+
+template <typename SampleType, int NumChannels>
+void FixedChannelChain<SampleType, NumChannels>::processInputStages(const SampleType* const* channels, int numSamples) noexcept
+{
+    updateCrossoverMode();
+
+    // Only the crossover frequencies at the end of the sub-block are needed: the filters glide
+    // their coefficients there per sample, the linear-phase kernels follow once per partition
+    lowCrossoverRamp.skip(parameters.lowCrossover, numSamples);
+    highCrossoverRamp.skip(parameters.highCrossover, numSamples);
+
+    float splitFrequencies[maxBands - 1];
+    getSplitFrequencies(splitFrequencies);
+    crossoverTree.glideSplitFrequencies(splitFrequencies, numSamples);
+    linearPhaseCrossover.setFrequencies(splitFrequencies, activeNumBands);
+
+    auto* const* dry = scratchArena.getChannels(dryScratch);
+    SampleType* const* bands[maxBands];
+
+    for (int band = 0; band < activeNumBands; ++band)
+        bands[band] = scratchArena.getChannels(firstBandScratch + band);
+
+    const int numBands = activeNumBands;
+    const bool splitHere = ! activeLinearPhaseCrossover;
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        SampleType frame[numChannels];
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            frame[channel] = lowShelfFilters[(size_t)channel].processSample(channels[channel][sample]);
+
+        // The gate may be stereo linked, so it sees all channels of a sample at once
+        preDistortionGate.processFrame(frame, numChannels);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            // Store the signal after pre-distortion compression and split it into bands
+            const SampleType input = preDistortionCompressor.processSample(channel, frame[channel]);
+            dry[channel][sample] = input;
+
+            if (splitHere)
+            {
+                SampleType bandSamples[maxBands];
+                crossoverTree.processSample(channel, input, bandSamples);
+
+                for (int band = 0; band < numBands; ++band)
+                    bands[band][channel][sample] = bandSamples[band];
+            }
+        }
+
+        crossoverTree.advance();
+    }
+
+    // The linear-phase crossover delays the dry copy along with the bands, so everything downstream stays aligned
+    if (! splitHere)
+        linearPhaseCrossover.process(dry, dry, bands, numSamples);
+}
+
+template <typename SampleType, int NumChannels>
+void FixedChannelChain<SampleType, NumChannels>::updateCrossoverMode() noexcept
+{
+    // Switching crossover starts the newly selected one from a clean state
+    if (parameters.linearPhaseCrossover == activeLinearPhaseCrossover)
+        return;
+
+    activeLinearPhaseCrossover = parameters.linearPhaseCrossover;
+
+    if (activeLinearPhaseCrossover)
+        linearPhaseCrossover.reset();
+    else
+        crossoverTree.reset();
+}
+
+template <typename SampleType, int NumChannels>
+void FixedChannelChain<SampleType, NumChannels>::updateBandLayout() noexcept
+{
+    bool layoutChanged = parameters.bandShapes != activeBandShapes;
+
+    // A new band count starts the crossovers and ADAA from a clean state at the current split frequencies
+    if (parameters.numBands != activeNumBands)
+    {
+        activeNumBands = parameters.numBands;
+        layoutChanged = true;
+
+        float splitFrequencies[maxBands - 1];
+        getSplitFrequencies(splitFrequencies);
+
+        crossoverTree.setNumBands(activeNumBands);
+        crossoverTree.setSplitFrequencies(splitFrequencies);
+        linearPhaseCrossover.setFrequencies(splitFrequencies, activeNumBands);
+        linearPhaseCrossover.reset();
+        adaaShaper.reset();
+    }
+
+    if (layoutChanged)
+    {
+        activeBandShapes = parameters.bandShapes;
+        bandLayout = MultibandShaper::makeLayout(activeNumBands, activeBandShapes);
+        adaaShaper.setLayout(bandLayout);
+    }
+
+    // The tables are rebuilt in the background, until then the previous curves stay in use.
+    // If the builder is busy the request is simply repeated next block.
+    const auto curves = MultibandShaper::getCurves(bandLayout);
+
+    if (curves != requestedTableCurves && waveshaperTables.tryRequestCurves(curves))
+        requestedTableCurves = curves;
+}
+
+template <typename SampleType, int NumChannels>
+void FixedChannelChain<SampleType, NumChannels>::getSplitFrequencies(float* frequencies) const noexcept
+{
+    CrossoverTree<SampleType>::getSplitFrequencies(lowCrossoverRamp.getCurrentValue(), highCrossoverRamp.getCurrentValue(),
+                                                   activeNumBands, frequencies);
+}
+
+template <typename SampleType, int NumChannels>
+void FixedChannelChain<SampleType, NumChannels>::processOutputStages(SampleType* const* channels, int numSamples) noexcept
+{
+    blendRamp.advance(parameters.blend, numSamples);
+    toneRamp.advance(parameters.tone, numSamples);
+    volumeRamp.advance(parameters.volume, numSamples);
+
+    // Fading in a response starts the convolution from a clean state
+    const bool impulseResponseWasOff = impulseResponseRamp.getRamp() == nullptr && impulseResponseRamp.getCurrentValue() <= 0.0f;
+    impulseResponseRamp.advance(cabinetImpulseResponse.isLoaded() ? 1.0f : 0.0f, numSamples);
+    const float* impulseResponseValues = impulseResponseRamp.getRamp();
+    const float impulseResponseMix = impulseResponseRamp.getCurrentValue();
+    const bool convolve = impulseResponseValues != nullptr || impulseResponseMix > 0.0f;
+
+    if (convolve && impulseResponseWasOff)
+        cabinetImpulseResponse.reset();
+
+    const float* blendValues = blendRamp.getRamp();
+    const float* toneValues = toneRamp.getRamp();
+    const float* volumeValues = volumeRamp.getRamp();
+    const float blend = blendRamp.getCurrentValue();
+    const float volume = volumeRamp.getCurrentValue();
+
+    if (toneValues == nullptr)
+        toneLowPassFilter.setCutoffFrequency(toneRamp.getCurrentValue());
+
+    const auto* const* dry = scratchArena.getChannels(dryScratch);
+    const SampleType* const* bands[maxBands];
+
+    for (int band = 0; band < activeNumBands; ++band)
+        bands[band] = scratchArena.getChannels(firstBandScratch + band);
+
+    const int numBands = activeNumBands;
+    float* convolved[numChannels];
+    float* fadeScratch[numChannels];
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            convolved[channel] = scratchArena.getChannel(impulseResponseScratch, channel);
+            fadeScratch[channel] = scratchArena.getChannel(impulseResponseFadeScratch, channel);
+        }
+        else
+        {
+            convolved[channel] = floatShapingScratch.get() + channel * maxShapingSamples;
+            fadeScratch[channel] = convolved[channel] + numChannels * maxShapingSamples;
+        }
+    }
+
+    // The convolution works on whole blocks, so the recombined bands go through it ahead of the per-sample pass
+    if (convolve)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            for (int sample = 0; sample < numSamples; ++sample)
+            {
+                SampleType recombined = bands[0][channel][sample];
+
+                for (int band = 1; band < numBands; ++band)
+                    recombined += bands[band][channel][sample];
+
+                convolved[channel][sample] = (float)recombined;
+            }
+        }
+
+        cabinetImpulseResponse.process(convolved, fadeScratch, numSamples);
+    }
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        // While the tone cutoff moves it is updated every toneUpdateInterval samples,
+        // which is fine grained enough to avoid zipper noise
+        if (toneValues != nullptr && sample % toneUpdateInterval == 0)
+            toneLowPassFilter.setCutoffFrequency(toneValues[sample]);
+
+        const auto blendGain = (SampleType)(blendValues != nullptr ? blendValues[sample] : blend);
+        SampleType frame[numChannels];
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            // Recombine the bands and cut sub-bass and fizz with the cab sim
+            SampleType recombined = bands[0][channel][sample];
+
+            for (int band = 1; band < numBands; ++band)
+                recombined += bands[band][channel][sample];
+
+            SampleType distorted = cabSimulator.processSample(channel, recombined);
+
+            // A loaded impulse response replaces the voicing filters
+            if (convolve)
+            {
+                const auto mix = (SampleType)(impulseResponseValues != nullptr ? impulseResponseValues[sample] : impulseResponseMix);
+                distorted += mix * ((SampleType)convolved[channel][sample] - distorted);
+            }
+
+            // Mix with the pre-distortion compressed signal, then tone and post-distortion compression
+            const SampleType mixed = (SampleType(1) - blendGain) * dry[channel][sample] + blendGain * distorted;
+            frame[channel] = postDistortionCompressor.processSample(channel, toneLowPassFilter.processSample(channel, mixed));
+        }
+
+        postDistortionGate.processFrame(frame, numChannels);
+
+        const auto volumeGain = (SampleType)(volumeValues != nullptr ? volumeValues[sample] : volume);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            channels[channel][sample] = frame[channel] * volumeGain;
+    }
+}
+
+template <typename SampleType>
+double ProcessingChain<SampleType>::getTailLengthSeconds() noexcept
+{
+    return getTailSeconds();
+}
+
+template <typename SampleType>
+std::unique_ptr<ProcessingChain<SampleType>> ProcessingChain<SampleType>::create(int numChannels)
+{
+    jassert(numChannels == 1 || numChannels == 2);
+
+    if (numChannels == 1)
+        return std::make_unique<FixedChannelChain<SampleType, 1>>();
+
+    return std::make_unique<FixedChannelChain<SampleType, 2>>();
+}
+
+template class ProcessingChain<float>;
+template class ProcessingChain<double>;
+template class FixedChannelChain<float, 1>;
+template class FixedChannelChain<float, 2>;
+template class FixedChannelChain<double, 1>;
+template class FixedChannelChain<double, 2>;
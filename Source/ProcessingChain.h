@@ -0,0 +1,217 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ScratchArena.h"
+#include "CabSimulator.h"
+#include "CabinetImpulseResponse.h"
+#include "WaveshaperTable.h"
+#include "AdaaShaper.h"
+#include "NoiseGate.h"
+#include "ParameterRamp.h"
+#include "DelayBuffer.h"
+#include "LinearPhaseCrossover.h"
+#include "CrossoverTree.h"
+#include "MultibandShaper.h"
+
+//==============================================================================
+/** Parameter values of the processing chain, as plain numbers. */
+struct ChainParameters
+{
+    // Ranges of the crossover frequencies. They don't overlap, so the bands always stay in order.
+    static constexpr float minLowCrossover = 60.0f, maxLowCrossover = 600.0f;
+    static constexpr float minHighCrossover = 800.0f, maxHighCrossover = 6000.0f;
+
+    float volume = 0.5f;            // Output gain
+    float blend = 0.5f;             // 0 is the compressed dry signal, 1 fully distorted
+    float drive = 0.5f;             // 0..1
+    float tone = 10300.0f;          // Tone low pass cutoff in Hz
+    float gateThreshold = -80.0f;   // dB
+    float lowCrossover = 200.0f;    // Hz, lowest split between bands
+    float highCrossover = 2000.0f;  // Hz, highest split, the others are spaced evenly in pitch in between
+    int numBands = 3;               // MultibandShaper::minBands..maxBands
+    MultibandShaper::BandShapes bandShapes = MultibandShaper::getDefaultShapes(); // Only the first numBands are used
+    bool gateLinked = true;
+    bool useLookupTables = false;
+    int oversamplingStages = 0;     // Oversampling factor is 2^stages
+    bool linearPhaseOversampling = false;
+    bool linearPhaseCrossover = false;  // FFT crossover instead of Linkwitz-Riley, adds latency
+    int antiAliasing = 0;           // 0 is off, otherwise the ADAA order
+    bool bypassed = false;          // Crossfades to the latency compensated input
+};
+
+//==============================================================================
+/**
+    The DISTROAR signal chain for one sample type.
+
+    Blocks are processed in sub-blocks of subBlockSize samples, small enough for
+    every intermediate band to stay in L1. Per sub-block there is one fused pass
+    from the input up to the band split, the oversampled shaping, and one fused
+    pass from the recombination to the output volume.
+
+    Filters, compressors, gates and oversamplers all run and keep their state in
+    SampleType. The band shapers are float kernels; the double chain runs them on
+    float copies of the oversampled bands. Instantiated for float and double, see
+    DistroarEngine for the public interface.
+
+    create() returns a chain specialised for a fixed channel count, so mono
+    tracks only ever touch one channel.
+*/
+template <typename SampleType>
+class ProcessingChain
+{
+public:
+    static constexpr int maxOversamplingStages = 3; // Up to 8x
+    static constexpr int maxChannels = 2;
+    static constexpr int subBlockSize = 64;
+
+    virtual ~ProcessingChain() = default;
+
+    /** Creates a chain for numChannels channels, which must be 1 or 2. */
+    static std::unique_ptr<ProcessingChain> create(int numChannels);
+
+    virtual void prepare(double sampleRate, int maxBlockSize, const ChainParameters& initialParameters) = 0;
+    virtual void release() = 0;
+
+    virtual void setParameters(const ChainParameters& newParameters) noexcept = 0;
+
+    /** Loads a cabinet impulse response in the background, see CabinetImpulseResponse. */
+    virtual void loadImpulseResponse(const CabinetImpulseResponse::Settings& settings) = 0;
+
+    /** Offline rendering trades the cabinet's background work for deterministic output. Not for the audio thread. */
+    virtual void setNonRealtime(bool isNonRealtime) = 0;
+
+    /** Processes the chain's channels of the given array in place.
+
+        Once the input has been silent for long enough that every filter, compressor
+        and gate has decayed, blocks are cleared instead of processed and this
+        returns true.
+    */
+    virtual bool process(SampleType* const* channels, int numSamples) noexcept = 0;
+
+    /** How long the output keeps ringing after the input goes silent, not counting latency. */
+    static double getTailLengthSeconds() noexcept;
+
+    virtual int getLatencySamples() const noexcept = 0;
+    virtual int getNumChannels() const noexcept = 0;
+};
+
+//==============================================================================
+/** ProcessingChain with its channel count fixed at compile time. */
+template <typename SampleType, int NumChannels>
+class FixedChannelChain : public ProcessingChain<SampleType>
+{
+public:
+    static_assert(NumChannels >= 1 && NumChannels <= ProcessingChain<SampleType>::maxChannels);
+
+    using ProcessingChain<SampleType>::maxOversamplingStages;
+    using ProcessingChain<SampleType>::subBlockSize;
+
+    FixedChannelChain();
+
+    void prepare(double sampleRate, int maxBlockSize, const ChainParameters& initialParameters) override;
+    void release() override;
+
+    void setParameters(const ChainParameters& newParameters) noexcept override;
+    void loadImpulseResponse(const CabinetImpulseResponse::Settings& settings) override;
+    void setNonRealtime(bool isNonRealtime) override;
+
+    bool process(SampleType* const* channels, int numSamples) noexcept override;
+
+    int getLatencySamples() const noexcept override;
+    int getNumChannels() const noexcept override { return NumChannels; }
+
+private:
+    static constexpr int maxBands = MultibandShaper::maxBands;
+
+    // Slots of the scratch arena used while processing. The dry and band slots must stay
+    // next to each other, the oversampler treats the dry and used band slots as one block of channels.
+    // The convolution runs in float, so only the float chain has the impulse response slots; the
+    // arena is typed on SampleType, and floatShapingScratch is the one deliberate exception to
+    // keeping all scratch memory in it, holding the double chain's float copies instead.
+    enum ScratchSlot
+    {
+        dryScratch,
+        firstBandScratch,
+        lastBandScratch = firstBandScratch + maxBands - 1,
+        bypassScratch,
+        impulseResponseScratch,
+        impulseResponseFadeScratch,     // The previous response while crossfading
+        numScratchSlots
+    };
+
+    static constexpr int numShapingSlots = lastBandScratch - dryScratch + 1;
+    static constexpr int numArenaSlots = std::is_same_v<SampleType, float> ? numScratchSlots : impulseResponseScratch;
+    static_assert(maxBands == LinearPhaseCrossover::maxBands);
+    static constexpr int toneUpdateInterval = 32;   // Samples between tone filter updates while it is moving
+    static constexpr double parameterRampSeconds = 0.05;
+    static constexpr double bypassFadeSeconds = 0.02;
+
+    void processChunk(SampleType* const* channels, int numSamples);
+    void processInputStages(const SampleType* const* channels, int numSamples) noexcept;
+    void processOutputStages(SampleType* const* channels, int numSamples) noexcept;
+    void updateCrossoverMode() noexcept;
+    void updateBandLayout() noexcept;
+    void getSplitFrequencies(float* frequencies) const noexcept;
+    void shapeBands(int channel, SampleType* const* bands, const SampleType* input, int numSamples,
+                    float drive, const float* driveValues);
+    void shapeFloatBands(int channel, float* const* bands, const float* input, int numSamples,
+                         float drive, const float* driveValues);
+    bool isSilent(SampleType* const* channels, int numSamples) const noexcept;
+    void skipIdleBlock(SampleType* const* channels, int numSamples) noexcept;
+    void resetState() noexcept;
+    void updateOversampling();
+    juce::dsp::Oversampling<SampleType>* getOversampler(const ChainParameters& settings) const noexcept;
+
+    static constexpr int numChannels = NumChannels;
+
+    ChainParameters parameters;
+    double sampleRate = 0.0;
+
+    juce::OwnedArray<juce::dsp::Oversampling<SampleType>> oversamplers; // One per band count, filter type and factor
+    juce::dsp::Oversampling<SampleType>* activeOversampler = nullptr;
+    int activeOversamplingChoice = -1;
+
+    ScratchArena<SampleType> scratchArena;
+    juce::HeapBlock<float> floatShapingScratch; // Double chain only: float copies of one channel's bands, then of the convolution's slots
+    int maxShapingSamples = 0;
+
+    std::array<juce::dsp::IIR::Filter<SampleType>, NumChannels> lowShelfFilters; // Input gain folded into the coefficients
+    CrossoverTree<SampleType> crossoverTree;
+    LinearPhaseCrossover linearPhaseCrossover;
+    bool activeLinearPhaseCrossover = false;
+    int activeNumBands = 0;
+    MultibandShaper::BandShapes activeBandShapes;
+    MultibandShaper::Layout bandLayout;
+    WaveshaperTableSet::Curves requestedTableCurves;  // Last curves the tables were asked for
+    juce::dsp::LinkwitzRileyFilter<SampleType> toneLowPassFilter;
+    juce::dsp::Compressor<SampleType> preDistortionCompressor;
+    juce::dsp::Compressor<SampleType> postDistortionCompressor;
+    CabSimulator<SampleType> cabSimulator;
+    CabinetImpulseResponse cabinetImpulseResponse;
+    ParameterRamp<> impulseResponseRamp;                // Fade from the voicing filters (0) to the impulse response (1)
+    WaveshaperTableSet waveshaperTables;
+    AdaaShaper adaaShaper;
+    NoiseGate<SampleType> preDistortionGate;
+    NoiseGate<SampleType> postDistortionGate;
+    int activeAntiAliasing = 0;
+
+    SampleType silenceThreshold = 0;
+    int settlingSamples = 0;        // Silent input needed before every state has decayed, not counting latency
+    int silentInputSamples = 0;     // Silent input processed since the last sound
+
+    // Smoothed parameters. The drive ramp runs at the oversampled rate of the shaping stage.
+    ParameterRamp<> driveRamp;
+    ParameterRamp<> blendRamp;
+    ParameterRamp<> volumeRamp;
+    ParameterRamp<juce::ValueSmoothingTypes::Multiplicative> toneRamp;
+    ParameterRamp<juce::ValueSmoothingTypes::Multiplicative> lowCrossoverRamp;
+    ParameterRamp<juce::ValueSmoothingTypes::Multiplicative> highCrossoverRamp;
+
+    // Bypass: the input delayed by the latency, and a fade from the processed signal (0) to it (1)
+    DelayBuffer<SampleType> bypassDelay;
+    ParameterRamp<> bypassRamp;
+    int maxLatencySamples = 0;
+    bool fullyBypassed = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FixedChannelChain)
+};
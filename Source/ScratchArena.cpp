@@ -0,0 +1,52 @@
+#include "ScratchArena.h"
+
+template <typename SampleType>
+void ScratchArena<SampleType>::prepare(int newNumSlots, int newNumChannels, int newMaxSamples)
+{
+    jassert(newNumSlots > 0 && newNumChannels > 0 && newMaxSamples > 0);
+
+    numSlots = newNumSlots;
+    numChannels = newNumChannels;
+    maxSamples = newMaxSamples;
+
+    // Round each channel up to a whole number of cache lines so every channel stays aligned
+    constexpr size_t samplesPerLine = alignment / sizeof(SampleType);
+    const size_t channelStride = ((size_t)maxSamples + samplesPerLine - 1) / samplesPerLine * samplesPerLine;
+    const size_t numChannelsTotal = (size_t)numSlots * (size_t)numChannels;
+
+    sizeInBytes = numChannelsTotal * channelStride * sizeof(SampleType);
+    storage.calloc(sizeInBytes + alignment);
+    channelPointers.malloc(numChannelsTotal);
+
+    auto address = reinterpret_cast<uintptr_t>(storage.get());
+    auto* base = reinterpret_cast<SampleType*>((address + alignment - 1) & ~(uintptr_t)(alignment - 1));
+
+    for (size_t i = 0; i < numChannelsTotal; ++i)
+        channelPointers[i] = base + i * channelStride;
+}
+
+template <typename SampleType>
+void ScratchArena<SampleType>::release()
+{
+    storage.free();
+    channelPointers.free();
+    numSlots = numChannels = maxSamples = 0;
+    sizeInBytes = 0;
+}
+
+template <typename SampleType>
+SampleType* const* ScratchArena<SampleType>::getChannels(int slot) const noexcept
+{
+    jassert(juce::isPositiveAndBelow(slot, numSlots));
+    return channelPointers.get() + (size_t)slot * (size_t)numChannels;
+}
+
+template <typename SampleType>
+SampleType* ScratchArena<SampleType>::getChannel(int slot, int channel) const noexcept
+{
+    jassert(juce::isPositiveAndBelow(channel, numChannels));
+    return getChannels(slot)[channel];
+}
+
+template class ScratchArena<float>;
+template class ScratchArena<double>;
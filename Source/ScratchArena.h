@@ -0,0 +1,48 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    One contiguous, 64-byte-aligned block of scratch memory for the audio thread.
+
+    The arena is carved into a fixed number of slots, each holding numChannels
+    channels of maxSamples samples. Every channel starts on a 64-byte boundary.
+    All memory is allocated in prepare(), so handing out slots while processing
+    never touches the heap.
+*/
+template <typename SampleType>
+class ScratchArena
+{
+public:
+    static constexpr size_t alignment = 64;
+
+    ScratchArena() = default;
+
+    /** Allocates (or reallocates) the arena. Call from prepareToPlay only. */
+    void prepare(int numSlots, int numChannels, int maxSamples);
+
+    /** Frees the arena's memory. */
+    void release();
+
+    /** Returns the channel pointers of a slot. */
+    SampleType* const* getChannels(int slot) const noexcept;
+
+    /** Returns one channel of a slot. */
+    SampleType* getChannel(int slot, int channel) const noexcept;
+
+    int getNumSlots() const noexcept { return numSlots; }
+    int getNumChannels() const noexcept { return numChannels; }
+    int getMaxSamples() const noexcept { return maxSamples; }
+    size_t getSizeInBytes() const noexcept { return sizeInBytes; }
+
+private:
+    juce::HeapBlock<char> storage;
+    juce::HeapBlock<SampleType*> channelPointers;
+    int numSlots = 0;
+    int numChannels = 0;
+    int maxSamples = 0;
+    size_t sizeInBytes = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScratchArena)
+};
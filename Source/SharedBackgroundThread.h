@@ -0,0 +1,29 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    A worker thread shared by every plugin instance in the process, for work that
+    must stay off the audio thread (table rebuilds, file loading).
+
+    Hold it through a juce::SharedResourcePointer so it is started with the first
+    instance and stopped with the last.
+*/
+class SharedBackgroundThread : public juce::TimeSliceThread
+{
+public:
+    SharedBackgroundThread()
+        : juce::TimeSliceThread("DISTROAR Background")
+    {
+        startThread();
+    }
+
+    ~SharedBackgroundThread() override
+    {
+        stopThread(2000);
+    }
+
+private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedBackgroundThread)
+};
@@ -0,0 +1,326 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// The widest instruction set enabled for the build picks the register width:
+// AVX-512 (16 lanes), AVX2 (8 lanes), SSE2 (4 lanes) or plain scalar code.
+// The .jucer exporters build with AVX2 and FMA; the README has the minimum CPU.
+#if defined(__AVX512F__)
+ #define DISTROAR_SIMD_AVX512 1
+#elif defined(__AVX2__)
+ #define DISTROAR_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #define DISTROAR_SIMD_SSE2 1
+#endif
+
+#if DISTROAR_SIMD_AVX512 || DISTROAR_SIMD_AVX2 || DISTROAR_SIMD_SSE2
+ #include <immintrin.h>
+#endif
+
+//==============================================================================
+/**
+    A register of floats for the widest SIMD instruction set enabled at compile time.
+
+    Unlike juce::dsp::SIMDRegister this also covers AVX-512, native division and
+    the float/integer bit tricks the fast math approximations need.
+    Loads and stores are unaligned, so any float pointer can be used.
+*/
+struct SimdFloat
+{
+#if DISTROAR_SIMD_AVX512
+    using Native = __m512;
+    using Mask = __mmask16;
+    static constexpr int size = 16;
+#elif DISTROAR_SIMD_AVX2
+    using Native = __m256;
+    using Mask = __m256;
+    static constexpr int size = 8;
+#elif DISTROAR_SIMD_SSE2
+    using Native = __m128;
+    using Mask = __m128;
+    static constexpr int size = 4;
+#else
+    using Native = float;
+    using Mask = bool;
+    static constexpr int size = 1;
+#endif
+
+    Native value;
+
+    //==============================================================================
+    static forcedinline SimdFloat load(const float* source) noexcept
+    {
+#if DISTROAR_SIMD_AVX512
+        return { _mm512_loadu_ps(source) };
+#elif DISTROAR_SIMD_AVX2
+        return { _mm256_loadu_ps(source) };
+#elif DISTROAR_SIMD_SSE2
+        return { _mm_loadu_ps(source) };
+#else
+        return { *source };
+#endif
+    }
+
+    forcedinline void store(float* destination) const noexcept
+    {
+#if DISTROAR_SIMD_AVX512
+        _mm512_storeu_ps(destination, value);
+#elif DISTROAR_SIMD_AVX2
+        _mm256_storeu_ps(destination, value);
+#elif DISTROAR_SIMD_SSE2
+        _mm_storeu_ps(destination, value);
+#else
+        *destination = value;
+#endif
+    }
+
+    static forcedinline SimdFloat broadcast(float scalar) noexcept
+    {
+#if DISTROAR_SIMD_AVX512
+        return { _mm512_set1_ps(scalar) };
+#elif DISTROAR_SIMD_AVX2
+        return { _mm256_set1_ps(scalar) };
+#elif DISTROAR_SIMD_SSE2
+        return { _mm_set1_ps(scalar) };
+#else
+        return { scalar };
+#endif
+    }
+
+    //==============================================================================
+    friend forcedinline SimdFloat operator+(SimdFloat a, SimdFloat b) noexcept
+    {
+#if DISTROAR_SIMD_AVX512
+        return { _mm512_add_ps(a.value, b.value) };
+#elif DISTROAR_SIMD_AVX2
+        return { _mm256_add_ps(a.value, b.value) };
+#elif DISTROAR_SIMD_SSE2
+        return { _mm_add_ps(a.value, b.value) };
+#else
+        return { a.value + b.value };
+#endif
+    }
+
+    friend forcedinline SimdFloat operator-(SimdFloat a, SimdFloat b) noexcept
+    {
+#if DISTROAR_SIMD_AVX512
+        return { _mm512_sub_ps(a.value, b.value) };
+#elif DISTROAR_SIMD_AVX2
+        return { _mm256_sub_ps(a.value, b.value) };
+#elif DISTROAR_SIMD_SSE2
+        return { _mm_sub_ps(a.value, b.value) };
+#else
+        return { a.value - b.value };
+#endif
+    }
+
+    friend forcedinline SimdFloat operator*(SimdFloat a, SimdFloat b) noexcept
+    {
+#if DISTROAR_SIMD_AVX512
+        return { _mm512_mul_ps(a.value, b.value) };
+#elif DISTROAR_SIMD_AVX2
+        return { _mm256_mul_ps(a.value, b.value) };
+#elif DISTROAR_SIMD_SSE2
+        return { _mm_mul_ps(a.value, b.value) };
+#else
+        return { a.value * b.value };
+#endif
+    }
+
+    friend forcedinline SimdFloat operator/(SimdFloat a, SimdFloat b) noexcept
+    {
+#if DISTROAR_SIMD_AVX512
+        return { _mm512_div_ps(a.value, b.value) };
+#elif DISTROAR_SIMD_AVX2
+        return { _mm256_div_ps(a.value, b.value) };
+#elif DISTROAR_SIMD_SSE2
+        return { _mm_div_ps(a.value, b.value) };
+#else
+        return { a.value / b.value };
+#endif
+    }
+
+    friend forcedinline SimdFloat operator*(SimdFloat a, float b) noexcept { return a * broadcast(b); }
+    friend forcedinline SimdFloat operator+(SimdFloat a, float b) noexcept { return a + broadcast(b); }
+
+    /** Returns a * b + c, fused where the instruction set allows it. */
+    static forcedinline SimdFloat mulAdd(SimdFloat a, SimdFloat b, SimdFloat c) noexcept
+    {
+#if DISTROAR_SIMD_AVX512
+        return { _mm512_fmadd_ps(a.value, b.value, c.value) };
+#elif DISTROAR_SIMD_AVX2 && (defined(__FMA__) || defined(_MSC_VER))
+        return { _mm256_fmadd_ps(a.value, b.value, c.value) };
+#else
+        return a * b + c;
+#endif
+    }
+
+    static forcedinline SimdFloat min(SimdFloat a, SimdFloat b) noexcept
+    {
+#if DISTROAR_SIMD_AVX512
+        return { _mm512_min_ps(a.value, b.value) };
+#elif DISTROAR_SIMD_AVX2
+        return { _mm256_min_ps(a.value, b.value) };
+#elif DISTROAR_SIMD_SSE2
+        return { _mm_min_ps(a.value, b.value) };
+#else
+        return { a.value < b.value ? a.value : b.value };
+#endif
+    }
+
+    static forcedinline SimdFloat max(SimdFloat a, SimdFloat b) noexcept
+    {
+#if DISTROAR_SIMD_AVX512
+        return { _mm512_max_ps(a.value, b.value) };
+#elif DISTROAR_SIMD_AVX2
+        return { _mm256_max_ps(a.value, b.value) };
+#elif DISTROAR_SIMD_SSE2
+        return { _mm_max_ps(a.value, b.value) };
+#else
+        return { a.value > b.value ? a.value : b.value };
+#endif
+    }
+
+    static forcedinline SimdFloat clamp(SimdFloat x, float lower, float upper) noexcept
+    {
+        return min(max(x, broadcast(lower)), broadcast(upper));
+    }
+
+    static forcedinline SimdFloat sqrt(SimdFloat x) noexcept
+    {
+#if DISTROAR_SIMD_AVX512
+        return { _mm512_sqrt_ps(x.value) };
+#elif DISTROAR_SIMD_AVX2
+        return { _mm256_sqrt_ps(x.value) };
+#elif DISTROAR_SIMD_SSE2
+        return { _mm_sqrt_ps(x.value) };
+#else
+        return { std::sqrt(x.value) };
+#endif
+    }
+
+    //==============================================================================
+    static forcedinline SimdFloat abs(SimdFloat x) noexcept
+    {
+        return fromBits(andBits(toBits(x), 0x7fffffff));
+    }
+
+    /** Returns the magnitude of the first argument with the sign of the second. */
+    static forcedinline SimdFloat copySign(SimdFloat magnitude, SimdFloat sign) noexcept
+    {
+        return fromBits(andBits(toBits(magnitude), 0x7fffffff), andBits(toBits(sign), (int)0x80000000));
+    }
+
+    static forcedinline Mask lessThan(SimdFloat a, SimdFloat b) noexcept
+    {
+#if DISTROAR_SIMD_AVX512
+        return _mm512_cmp_ps_mask(a.value, b.value, _CMP_LT_OQ);
+#elif DISTROAR_SIMD_AVX2
+        return _mm256_cmp_ps(a.value, b.value, _CMP_LT_OQ);
+#elif DISTROAR_SIMD_SSE2
+        return _mm_cmplt_ps(a.value, b.value);
+#else
+        return a.value < b.value;
+#endif
+    }
+
+    /** Picks a where the mask is set and b elsewhere. */
+    static forcedinline SimdFloat select(Mask mask, SimdFloat a, SimdFloat b) noexcept
+    {
+#if DISTROAR_SIMD_AVX512
+        return { _mm512_mask_blend_ps(mask, b.value, a.value) };
+#elif DISTROAR_SIMD_AVX2
+        return { _mm256_blendv_ps(b.value, a.value, mask) };
+#elif DISTROAR_SIMD_SSE2
+        return { _mm_or_ps(_mm_and_ps(mask, a.value), _mm_andnot_ps(mask, b.value)) };
+#else
+        return mask ? a : b;
+#endif
+    }
+
+    //==============================================================================
+    /** Rounds every lane to the nearest integer. */
+    static forcedinline SimdFloat round(SimdFloat x) noexcept
+    {
+#if DISTROAR_SIMD_AVX512
+        return { _mm512_cvtepi32_ps(_mm512_cvtps_epi32(x.value)) };
+#elif DISTROAR_SIMD_AVX2
+        return { _mm256_cvtepi32_ps(_mm256_cvtps_epi32(x.value)) };
+#elif DISTROAR_SIMD_SSE2
+        return { _mm_cvtepi32_ps(_mm_cvtps_epi32(x.value)) };
+#else
+        return { std::nearbyint(x.value) };
+#endif
+    }
+
+    /** Returns 2^n for integral lanes n in [-126, 127]. */
+    static forcedinline SimdFloat powerOfTwo(SimdFloat n) noexcept
+    {
+#if DISTROAR_SIMD_AVX512
+        return { _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(n.value), _mm512_set1_epi32(127)), 23)) };
+#elif DISTROAR_SIMD_AVX2
+        return { _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n.value), _mm256_set1_epi32(127)), 23)) };
+#elif DISTROAR_SIMD_SSE2
+        return { _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n.value), _mm_set1_epi32(127)), 23)) };
+#else
+        const auto bits = ((int32_t)n.value + 127) << 23;
+        float result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return { result };
+#endif
+    }
+
+    /** Splits positive normal lanes into a mantissa in [1, 2) and an integral exponent. */
+    static forcedinline SimdFloat splitExponent(SimdFloat x, SimdFloat& exponent) noexcept
+    {
+#if DISTROAR_SIMD_AVX512
+        const auto bits = _mm512_castps_si512(x.value);
+        exponent.value = _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(bits, 23), _mm512_set1_epi32(127)));
+        return { _mm512_castsi512_ps(_mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi32(0x007fffff)), _mm512_set1_epi32(0x3f800000))) };
+#elif DISTROAR_SIMD_AVX2
+        const auto bits = _mm256_castps_si256(x.value);
+        exponent.value = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+        return { _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007fffff)), _mm256_set1_epi32(0x3f800000))) };
+#elif DISTROAR_SIMD_SSE2
+        const auto bits = _mm_castps_si128(x.value);
+        exponent.value = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+        return { _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000))) };
+#else
+        int32_t bits;
+        std::memcpy(&bits, &x.value, sizeof(bits));
+        exponent.value = (float)((bits >> 23) - 127);
+        bits = (bits & 0x007fffff) | 0x3f800000;
+        float mantissa;
+        std::memcpy(&mantissa, &bits, sizeof(mantissa));
+        return { mantissa };
+#endif
+    }
+
+private:
+    //==============================================================================
+#if DISTROAR_SIMD_AVX512
+    using Bits = __m512i;
+    static forcedinline Bits toBits(SimdFloat x) noexcept { return _mm512_castps_si512(x.value); }
+    static forcedinline SimdFloat fromBits(Bits b) noexcept { return { _mm512_castsi512_ps(b) }; }
+    static forcedinline SimdFloat fromBits(Bits a, Bits b) noexcept { return { _mm512_castsi512_ps(_mm512_or_si512(a, b)) }; }
+    static forcedinline Bits andBits(Bits b, int mask) noexcept { return _mm512_and_si512(b, _mm512_set1_epi32(mask)); }
+#elif DISTROAR_SIMD_AVX2
+    using Bits = __m256i;
+    static forcedinline Bits toBits(SimdFloat x) noexcept { return _mm256_castps_si256(x.value); }
+    static forcedinline SimdFloat fromBits(Bits b) noexcept { return { _mm256_castsi256_ps(b) }; }
+    static forcedinline SimdFloat fromBits(Bits a, Bits b) noexcept { return { _mm256_castsi256_ps(_mm256_or_si256(a, b)) }; }
+    static forcedinline Bits andBits(Bits b, int mask) noexcept { return _mm256_and_si256(b, _mm256_set1_epi32(mask)); }
+#elif DISTROAR_SIMD_SSE2
+    using Bits = __m128i;
+    static forcedinline Bits toBits(SimdFloat x) noexcept { return _mm_castps_si128(x.value); }
+    static forcedinline SimdFloat fromBits(Bits b) noexcept { return { _mm_castsi128_ps(b) }; }
+    static forcedinline SimdFloat fromBits(Bits a, Bits b) noexcept { return { _mm_castsi128_ps(_mm_or_si128(a, b)) }; }
+    static forcedinline Bits andBits(Bits b, int mask) noexcept { return _mm_and_si128(b, _mm_set1_epi32(mask)); }
+#else
+    using Bits = int32_t;
+    static forcedinline Bits toBits(SimdFloat x) noexcept { Bits b; std::memcpy(&b, &x.value, sizeof(b)); return b; }
+    static forcedinline SimdFloat fromBits(Bits b) noexcept { float f; std::memcpy(&f, &b, sizeof(f)); return { f }; }
+    static forcedinline SimdFloat fromBits(Bits a, Bits b) noexcept { return fromBits(a | b); }
+    static forcedinline Bits andBits(Bits b, int mask) noexcept { return b & mask; }
+#endif
+};
@@ -0,0 +1,64 @@
+#include "SmoothedLinkwitzRiley.h"
+
+template <typename SampleType>
+void SmoothedLinkwitzRiley<SampleType>::setType(Type newType) noexcept
+{
+    jassert(newType != Type::allpass);
+    type = newType;
+}
+
+template <typename SampleType>
+void SmoothedLinkwitzRiley<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    jassert(spec.sampleRate > 0 && spec.numChannels > 0);
+
+    sampleRate = spec.sampleRate;
+    state.resize(spec.numChannels);
+
+    setCutoffFrequency(cutoffFrequency);
+    reset();
+}
+
+template <typename SampleType>
+void SmoothedLinkwitzRiley<SampleType>::reset() noexcept
+{
+    for (auto& channelState : state)
+        channelState.fill(SampleType(0));
+}
+
+template <typename SampleType>
+void SmoothedLinkwitzRiley<SampleType>::setCutoffFrequency(SampleType newCutoffFrequency) noexcept
+{
+    cutoffFrequency = newCutoffFrequency;
+    targetG = g = getPrewarpedCutoff(cutoffFrequency);
+    h = SampleType(1) / (SampleType(1) + R2 * g + g * g);
+    glideSamples = 0;
+}
+
+template <typename SampleType>
+void SmoothedLinkwitzRiley<SampleType>::glideCutoffFrequency(SampleType newCutoffFrequency, int numSamples) noexcept
+{
+    if (newCutoffFrequency == cutoffFrequency)
+        return;
+
+    if (numSamples <= 0)
+    {
+        setCutoffFrequency(newCutoffFrequency);
+        return;
+    }
+
+    cutoffFrequency = newCutoffFrequency;
+    targetG = getPrewarpedCutoff(cutoffFrequency);
+    gStep = (targetG - g) / (SampleType)numSamples;
+    glideSamples = numSamples;
+}
+
+template <typename SampleType>
+SampleType SmoothedLinkwitzRiley<SampleType>::getPrewarpedCutoff(SampleType frequency) const noexcept
+{
+    jassert(frequency > 0 && frequency < sampleRate * 0.5);
+    return (SampleType)std::tan(juce::MathConstants<double>::pi * (double)frequency / sampleRate);
+}
+
+template class SmoothedLinkwitzRiley<float>;
+template class SmoothedLinkwitzRiley<double>;
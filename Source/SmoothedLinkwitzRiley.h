@@ -0,0 +1,86 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Linkwitz-Riley low or high pass whose cutoff can glide without clicks.
+
+    Same topology as juce::dsp::LinkwitzRileyFilter, two cascaded TPT state
+    variable sections, so it can be modulated. A cutoff change only computes the
+    coefficient for the end of the glide; in between, the prewarped cutoff is
+    stepped linearly per sample. Moving the cutoff costs one division per sample
+    instead of a tan(), and a settled filter costs nothing extra.
+*/
+template <typename SampleType>
+class SmoothedLinkwitzRiley
+{
+public:
+    using Type = juce::dsp::LinkwitzRileyFilterType;
+
+    SmoothedLinkwitzRiley() = default;
+
+    /** Low or high pass only, there is no allpass mode. */
+    void setType(Type newType) noexcept;
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset() noexcept;
+
+    /** Jumps straight to a new cutoff. */
+    void setCutoffFrequency(SampleType newCutoffFrequency) noexcept;
+
+    /** Glides from the current cutoff to newCutoffFrequency over the next numSamples
+        calls to advance(). Does nothing if the cutoff is already there.
+    */
+    void glideCutoffFrequency(SampleType newCutoffFrequency, int numSamples) noexcept;
+
+    SampleType getCutoffFrequency() const noexcept { return cutoffFrequency; }
+
+    /** Filters one sample of one channel. Call advance() once every channel of the sample is done. */
+    SampleType processSample(int channel, SampleType input) noexcept
+    {
+        auto& s = state[(size_t)channel];
+
+        const SampleType yH = (input - (R2 + g) * s[0] - s[1]) * h;
+        const SampleType yB = g * yH + s[0];
+        s[0] = g * yH + yB;
+        const SampleType yL = g * yB + s[1];
+        s[1] = g * yB + yL;
+
+        const SampleType yH2 = ((type == Type::lowpass ? yL : yH) - (R2 + g) * s[2] - s[3]) * h;
+        const SampleType yB2 = g * yH2 + s[2];
+        s[2] = g * yH2 + yB2;
+        const SampleType yL2 = g * yB2 + s[3];
+        s[3] = g * yB2 + yL2;
+
+        return type == Type::lowpass ? yL2 : yH2;
+    }
+
+    /** Steps a glide on by one sample. */
+    void advance() noexcept
+    {
+        if (glideSamples > 0)
+        {
+            --glideSamples;
+            g = glideSamples > 0 ? g + gStep : targetG;
+            h = SampleType(1) / (SampleType(1) + R2 * g + g * g);
+        }
+    }
+
+private:
+    static constexpr SampleType R2 = juce::MathConstants<SampleType>::sqrt2;
+
+    SampleType getPrewarpedCutoff(SampleType frequency) const noexcept;
+
+    Type type = Type::lowpass;
+    double sampleRate = 44100.0;
+    SampleType cutoffFrequency = 2000;
+
+    SampleType g = 0, h = 0;        // Current coefficients
+    SampleType targetG = 0, gStep = 0;
+    int glideSamples = 0;
+
+    std::vector<std::array<SampleType, 4>> state; // Integrator states of both sections, per channel
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SmoothedLinkwitzRiley)
+};
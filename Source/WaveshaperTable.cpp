@@ -0,0 +1,135 @@
+#include "WaveshaperTable.h"
+
+void WaveshaperTable::build(const ShaperCurve& curve, int numPoints, Interpolation newInterpolation)
+{
+    jassert(numPoints >= 2 && curve.clipLevel > 0.0f);
+
+    interpolation = newInterpolation;
+    start = -curve.clipLevel;
+    lastIndex = (float)(numPoints - 1);
+
+    const float step = 2.0f * curve.clipLevel / lastIndex;
+    pointsPerUnit = 1.0f / step;
+
+    values.resize((size_t)numPoints + 3);
+
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = curve.evaluate(start + ((float)i - 1.0f) * step);
+
+    // Probe between the points to find the worst interpolation error
+    constexpr int probesPerInterval = 8;
+    maxError = 0.0f;
+
+    for (int i = 0; i <= (numPoints - 1) * probesPerInterval; ++i)
+    {
+        const float x = start + (float)i * step / (float)probesPerInterval;
+        maxError = juce::jmax(maxError, std::abs(processSample(x) - curve.evaluate(x)));
+    }
+}
+
+//==============================================================================
+WaveshaperTableSet::WaveshaperTableSet(const Curves& initialCurves, int numPoints, WaveshaperTable::Interpolation interpolation)
+    : requestedCurves(initialCurves), requestedNumPoints(numPoints), requestedInterpolation(interpolation)
+{
+    // Build the first tables right away so the audio thread always has something to read
+    buildTables(storage[0], initialCurves, numPoints, interpolation);
+    active = &storage[0];
+
+    freeTables.ensureStorageAllocated((int)storage.size());
+    freeTables.add(&storage[1]);
+    freeTables.add(&storage[2]);
+
+    backgroundThread->addTimeSliceClient(this);
+}
+
+WaveshaperTableSet::~WaveshaperTableSet()
+{
+    backgroundThread->removeTimeSliceClient(this);
+}
+
+void WaveshaperTableSet::setCurves(const Curves& curves, int numPoints, WaveshaperTable::Interpolation interpolation)
+{
+    const juce::ScopedLock sl(requestLock);
+    requestedCurves = curves;
+    requestedNumPoints = numPoints;
+    requestedInterpolation = interpolation;
+    rebuildRequested = true;
+}
+
+bool WaveshaperTableSet::tryRequestCurves(const Curves& curves) noexcept
+{
+    const juce::ScopedTryLock stl(requestLock);
+
+    if (! stl.isLocked())
+        return false;
+
+    requestedCurves = curves;
+    rebuildRequested = true;
+    return true;
+}
+
+const WaveshaperTableSet::Tables& WaveshaperTableSet::getTables() noexcept
+{
+    // Only switch once the builder has collected the tables retired by the previous switch
+    if (retired.load() == nullptr)
+    {
+        if (auto* newTables = pending.exchange(nullptr))
+        {
+            retired.store(active);
+            active = newTables;
+        }
+    }
+
+    return *active;
+}
+
+int WaveshaperTableSet::useTimeSlice()
+{
+    if (auto* oldTables = retired.exchange(nullptr))
+        freeTables.add(oldTables);
+
+    Curves curves;
+    int numPoints;
+    WaveshaperTable::Interpolation interpolation;
+
+    {
+        const juce::ScopedLock sl(requestLock);
+
+        if (!rebuildRequested)
+            return 20;
+
+        rebuildRequested = false;
+        curves = requestedCurves;
+        numPoints = requestedNumPoints;
+        interpolation = requestedInterpolation;
+    }
+
+    // If nothing is free, the audio thread has not picked up the last tables yet, so reuse those
+    auto* target = freeTables.isEmpty() ? pending.exchange(nullptr)
+                                        : freeTables.removeAndReturn(freeTables.size() - 1);
+    jassert(target != nullptr);
+
+    buildTables(*target, curves, numPoints, interpolation);
+
+    if (auto* unused = pending.exchange(target))
+        freeTables.add(unused);
+
+    return 20;
+}
+
+void WaveshaperTableSet::buildTables(Tables& target, const Curves& curves, int numPoints, WaveshaperTable::Interpolation interpolation)
+{
+    size_t totalSize = 0;
+    float worstError = 0.0f;
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        target.bands[(size_t)band].build(curves[(size_t)band], numPoints, interpolation);
+        totalSize += target.bands[(size_t)band].getSizeInBytes();
+        worstError = juce::jmax(worstError, target.bands[(size_t)band].getMaxError());
+    }
+
+    target.curves = curves;
+    sizeInBytes.store(totalSize);
+    maxError.store(worstError);
+}
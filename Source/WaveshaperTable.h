@@ -0,0 +1,144 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "SharedBackgroundThread.h"
+
+//==============================================================================
+/** A memoryless band transfer curve: clip to +-clipLevel, signed power, then scale. */
+struct ShaperCurve
+{
+    float clipLevel;
+    float exponent;
+    float outputScale;
+
+    float evaluate(float x) const noexcept
+    {
+        x = juce::jlimit(-clipLevel, clipLevel, x);
+        return (x > 0.0f ? std::pow(x, exponent) : -std::pow(-x, exponent)) * outputScale;
+    }
+
+    bool operator==(const ShaperCurve& other) const noexcept
+    {
+        return clipLevel == other.clipLevel && exponent == other.exponent && outputScale == other.outputScale;
+    }
+
+    bool operator!=(const ShaperCurve& other) const noexcept { return !operator==(other); }
+};
+
+//==============================================================================
+/**
+    A ShaperCurve sampled over [-clipLevel, clipLevel], read back with linear or
+    cubic (Catmull-Rom) interpolation. Inputs beyond the clip level land on the
+    flat ends of the table, so no clamp is needed before a lookup.
+*/
+class WaveshaperTable
+{
+public:
+    enum class Interpolation
+    {
+        linear,
+        cubic
+    };
+
+    WaveshaperTable() = default;
+
+    /** Fills the table and measures its interpolation error. Allocates, so never call it from the audio thread. */
+    void build(const ShaperCurve& curve, int numPoints, Interpolation interpolation);
+
+    float processSample(float x) const noexcept
+    {
+        const float position = juce::jlimit(0.0f, lastIndex, (x - start) * pointsPerUnit);
+        const int index = (int)position;
+        const float t = position - (float)index;
+        const float* v = values.data() + index; // v[1] is the point at index
+
+        if (interpolation == Interpolation::linear)
+            return v[1] + t * (v[2] - v[1]);
+
+        return v[1] + 0.5f * t * (v[2] - v[0] + t * (2.0f * v[0] - 5.0f * v[1] + 4.0f * v[2] - v[3]
+                                                     + t * (3.0f * (v[1] - v[2]) + v[3] - v[0])));
+    }
+
+    /** Largest absolute difference from the exact curve, measured when the table was built. */
+    float getMaxError() const noexcept { return maxError; }
+    size_t getSizeInBytes() const noexcept { return values.size() * sizeof(float); }
+
+private:
+    std::vector<float> values; // One guard point before the table, two after
+    Interpolation interpolation = Interpolation::cubic;
+    float start = 0.0f;
+    float pointsPerUnit = 0.0f;
+    float lastIndex = 0.0f;
+    float maxError = 0.0f;
+};
+
+//==============================================================================
+/**
+    The per-band tables of the multiband shaper, rebuilt on the shared background
+    thread whenever the curves change and handed to the audio thread lock-free.
+
+    Three table sets are allocated up front and passed around with atomic pointers:
+    the audio thread owns the active one, the builder fills a free one, publishes
+    it as pending, and gets the old active one back once the audio thread has
+    switched over.
+
+    The band drive only scales the signal going into a curve, so changing drive
+    never requires new tables.
+*/
+class WaveshaperTableSet : private juce::TimeSliceClient
+{
+public:
+    static constexpr int maxBands = 6;
+    using Curves = std::array<ShaperCurve, maxBands>;
+
+    struct Tables
+    {
+        std::array<WaveshaperTable, maxBands> bands;
+        Curves curves;
+    };
+
+    WaveshaperTableSet(const Curves& initialCurves, int numPoints = 2048,
+                       WaveshaperTable::Interpolation interpolation = WaveshaperTable::Interpolation::linear);
+    ~WaveshaperTableSet() override;
+
+    /** Requests new tables. Call from any thread except the audio thread. */
+    void setCurves(const Curves& curves, int numPoints, WaveshaperTable::Interpolation interpolation);
+
+    /** Requests new tables with the current table size, without blocking: returns false if the
+        builder was busy taking a request, in which case the caller should try again later.
+        Safe to call from the audio thread.
+    */
+    bool tryRequestCurves(const Curves& curves) noexcept;
+
+    /** Audio thread only: returns the tables to use for this block, switching to newly built ones if available. */
+    const Tables& getTables() noexcept;
+
+    /** Memory used by one table set. */
+    size_t getSizeInBytes() const noexcept { return sizeInBytes.load(); }
+
+    /** Worst interpolation error of the most recently built tables. */
+    float getMaxError() const noexcept { return maxError.load(); }
+
+private:
+    int useTimeSlice() override;
+    void buildTables(Tables& target, const Curves& curves, int numPoints, WaveshaperTable::Interpolation interpolation);
+
+    std::array<Tables, 3> storage;
+    Tables* active = nullptr;               // Audio thread
+    std::atomic<Tables*> pending { nullptr }; // Builder -> audio thread
+    std::atomic<Tables*> retired { nullptr }; // Audio thread -> builder
+    juce::Array<Tables*> freeTables;        // Builder
+
+    juce::CriticalSection requestLock;
+    Curves requestedCurves;
+    int requestedNumPoints;
+    WaveshaperTable::Interpolation requestedInterpolation;
+    bool rebuildRequested = false;
+
+    std::atomic<size_t> sizeInBytes { 0 };
+    std::atomic<float> maxError { 0.0f };
+
+    juce::SharedResourcePointer<SharedBackgroundThread> backgroundThread;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveshaperTableSet)
+};
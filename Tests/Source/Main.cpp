@@ -0,0 +1,435 @@
+/*
+    Unit tests for the DISTROAR processing code, linked against the DistroarCore library.
+
+    Runs every juce::UnitTest in the program and exits with 1 if any of them failed.
+
+    Usage: DistroarTests [--seed=<random seed>]
+*/
+
+#include <JuceHeader.h>
+#include "../../Source/MultibandShaper.h"
+#include "../../Source/AdaaShaper.h"
+#include "../../Source/PartitionedConvolution.h"
+#include "../../Source/SimdFloat.h"
+
+namespace
+{
+    //==============================================================================
+    /**
+        Checks the vectorised shaper kernel and the lookup table path against
+        MultibandShaper::processReference(), for every band count, with constant and
+        ramped drive, over lengths that leave a remainder after the SIMD loop.
+    */
+    class MultibandShaperTests : public juce::UnitTest
+    {
+    public:
+        MultibandShaperTests() : juce::UnitTest("MultibandShaper", "DSP") {}
+
+        void runTest() override
+        {
+            beginTest("process() matches processReference()");
+            forEveryCase([this](const Case& c) { checkPath(c, Path::vectorised); });
+
+            beginTest("processWithTables() matches processReference() within the table error");
+            forEveryCase([this](const Case& c) { checkPath(c, Path::tables); });
+        }
+
+    private:
+        enum class Path
+        {
+            vectorised,
+            tables
+        };
+
+        struct Case
+        {
+            MultibandShaper::Layout layout;
+            int numSamples;
+            bool rampDrive;
+        };
+
+        static constexpr int lengths[] = { 1, SimdFloat::size - 1, SimdFloat::size + 1, 67, 509 };
+
+        template <typename Callback>
+        void forEveryCase(Callback&& callback)
+        {
+            auto& random = getRandom();
+
+            for (int numBands = MultibandShaper::minBands; numBands <= MultibandShaper::maxBands; ++numBands)
+            {
+                for (int trial = 0; trial < 20; ++trial)
+                {
+                    // The first trial is the default voicing, the rest random shapes over the whole parameter range
+                    auto shapes = MultibandShaper::getDefaultShapes();
+
+                    if (trial > 0)
+                    {
+                        for (auto& shape : shapes)
+                            shape = { random.nextFloat() * BandShape::maxDrive,
+                                      juce::jmap(random.nextFloat(), BandShape::minClipLevel, BandShape::maxClipLevel),
+                                      juce::jmap(random.nextFloat(), BandShape::minExponent, BandShape::maxExponent) };
+                    }
+
+                    const auto layout = MultibandShaper::makeLayout(numBands, shapes);
+
+                    for (auto numSamples : lengths)
+                        for (auto rampDrive : { false, true })
+                            callback({ layout, numSamples, rampDrive });
+                }
+            }
+        }
+
+        void checkPath(const Case& c, Path path)
+        {
+            auto& random = getRandom();
+            const int numBands = c.layout.numBands;
+            const int numSamples = c.numSamples;
+
+            juce::AudioBuffer<float> expected(numBands, numSamples), actual(numBands, numSamples);
+            std::vector<float> input((size_t)numSamples), driveRamp((size_t)numSamples);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                input[(size_t)i] = random.nextFloat() * 3.0f - 1.5f;
+                driveRamp[(size_t)i] = (float)i / (float)numSamples;
+            }
+
+            for (int band = 0; band < numBands; ++band)
+            {
+                for (int i = 0; i < numSamples; ++i)
+                    expected.setSample(band, i, random.nextFloat() * 3.0f - 1.5f);
+
+                // Exact zeros take a separate branch in the signed power
+                expected.setSample(band, numSamples / 2, 0.0f);
+            }
+
+            actual.makeCopyOf(expected);
+
+            const float drive = 0.6f;
+            const float* ramp = c.rampDrive ? driveRamp.data() : nullptr;
+            float allowedError = MultibandShaper::tolerance;
+
+            MultibandShaper::processReference(expected.getArrayOfWritePointers(), input.data(), numSamples, drive, ramp, c.layout);
+
+            if (path == Path::vectorised)
+            {
+                MultibandShaper::process(actual.getArrayOfWritePointers(), input.data(), numSamples, drive, ramp, c.layout);
+            }
+            else
+            {
+                WaveshaperTableSet::Tables tables;
+                tables.curves = MultibandShaper::getCurves(c.layout);
+                float tableError = 0.0f;
+
+                for (int band = 0; band < MultibandShaper::maxBands; ++band)
+                {
+                    tables.bands[(size_t)band].build(tables.curves[(size_t)band], 2048, WaveshaperTable::Interpolation::linear);
+                    tableError = juce::jmax(tableError, tables.bands[(size_t)band].getMaxError());
+                }
+
+                MultibandShaper::processWithTables(actual.getArrayOfWritePointers(), input.data(), numSamples, drive, ramp,
+                                                   c.layout, tables);
+
+                allowedError += tableError * getTableErrorGain(c.layout);
+            }
+
+            float maxError = 0.0f;
+
+            for (int band = 0; band < numBands; ++band)
+                for (int i = 0; i < numSamples; ++i)
+                    maxError = juce::jmax(maxError, std::abs(actual.getSample(band, i) - expected.getSample(band, i)));
+
+            expect(maxError <= allowedError,
+                   juce::String(numBands) + " bands, " + juce::String(numSamples) + " samples, "
+                       + (c.rampDrive ? "ramped" : "constant") + " drive: error " + juce::String(maxError)
+                       + " exceeds " + juce::String(allowedError));
+        }
+
+        /** How much an error in the band curves can grow through the dynamic control. A band's output
+            is shaped * makeup / (1 + |sum of weighted shaped|), so an error e in every curve moves it
+            by at most makeup * e * (1 + |shaped| * sum of weights).
+        */
+        static float getTableErrorGain(const MultibandShaper::Layout& layout) noexcept
+        {
+            float sumOfWeights = 0.0f, maxShaped = 0.0f, maxMakeup = 0.0f;
+
+            for (int band = 0; band < layout.numBands; ++band)
+            {
+                const auto index = (size_t)band;
+                sumOfWeights += layout.weight[index];
+                maxShaped = juce::jmax(maxShaped, std::pow(layout.clipLevel[index], layout.exponent[index]) * layout.outputScale[index]);
+                maxMakeup = juce::jmax(maxMakeup, layout.makeup[index]);
+            }
+
+            return maxMakeup * (1.0f + maxShaped * sumOfWeights);
+        }
+    };
+
+    MultibandShaperTests multibandShaperTests;
+
+    //==============================================================================
+    /**
+        Checks 2nd order ADAA against the plain second difference quotient of the second
+        antiderivative, on well conditioned input and on an x, a, x, a sequence, where
+        x[n] == x[n - 2] and the shaper has to take the limit instead.
+
+        The drive is zero so the band signals reach the curves unchanged, and they stay
+        below the clip level so the antiderivative is a single power.
+    */
+    class AdaaShaperTests : public juce::UnitTest
+    {
+    public:
+        AdaaShaperTests() : juce::UnitTest("AdaaShaper", "DSP") {}
+
+        void runTest() override
+        {
+            auto& random = getRandom();
+            const auto layout = MultibandShaper::makeLayout(2, { { { 0.0f, 1.0f, 1.25f }, { 0.0f, 1.0f, 0.65f } } });
+
+            beginTest("2nd order matches the difference quotient on well conditioned input");
+            {
+                std::vector<float> signal(512);
+
+                for (auto& value : signal)
+                    value = random.nextFloat() * 1.8f - 0.9f;
+
+                check(layout, signal);
+            }
+
+            beginTest("2nd order takes the limit when x[n] equals x[n - 2]");
+            {
+                for (int trial = 0; trial < 20; ++trial)
+                {
+                    const float x = random.nextFloat() * 1.8f - 0.9f;
+                    const float a = random.nextFloat() * 1.8f - 0.9f;
+                    std::vector<float> signal(64);
+
+                    for (size_t i = 0; i < signal.size(); ++i)
+                        signal[i] = i % 2 == 0 ? x : a;
+
+                    check(layout, signal);
+                }
+            }
+        }
+
+    private:
+        /** Second antiderivative of a band curve below its clip level. */
+        static double antiderivative2(const ShaperCurve& curve, double x) noexcept
+        {
+            const double p = curve.exponent;
+            return std::copysign(curve.outputScale * std::pow(std::abs(x), p + 2.0) / ((p + 1.0) * (p + 2.0)), x);
+        }
+
+        /** 2 / (x0 - x2) * (D(x0, x1) - D(x1, x2)), D being the difference quotient of antiderivative2. */
+        static double secondDifferenceQuotient(const ShaperCurve& curve, double x0, double x1, double x2) noexcept
+        {
+            auto quotient = [&](double a, double b) { return (antiderivative2(curve, a) - antiderivative2(curve, b)) / (a - b); };
+            return 2.0 * (quotient(x0, x1) - quotient(x1, x2)) / (x0 - x2);
+        }
+
+        void check(const MultibandShaper::Layout& layout, const std::vector<float>& signal)
+        {
+            constexpr int numBands = 2;
+            const int numSamples = (int)signal.size();
+            const auto curves = MultibandShaper::getCurves(layout);
+
+            AdaaShaper shaper;
+            shaper.prepare(1);
+            shaper.setLayout(layout);
+
+            juce::AudioBuffer<float> bands(numBands, numSamples);
+            std::vector<float> input((size_t)numSamples, 0.0f);
+
+            for (int band = 0; band < numBands; ++band)
+                bands.copyFrom(band, 0, signal.data(), numSamples);
+
+            shaper.process(0, bands.getArrayOfWritePointers(), input.data(), numSamples, 0.0f, nullptr, AdaaShaper::Order::second);
+
+            float maxError = 0.0f;
+
+            // The first two outputs still depend on the zero history
+            for (int n = 2; n < numSamples; ++n)
+            {
+                const double x0 = signal[(size_t)n], x1 = signal[(size_t)n - 1], x2 = signal[(size_t)n - 2];
+                float shaped[numBands];
+                float weightedSum = 0.0f;
+
+                for (int band = 0; band < numBands; ++band)
+                {
+                    const auto& curve = curves[(size_t)band];
+
+                    // Where x0 == x2 the quotient is the limit, approached from both sides
+                    constexpr double h = 1.0e-4;
+                    const double expected = x0 != x2 ? secondDifferenceQuotient(curve, x0, x1, x2)
+                                                     : 0.5 * (secondDifferenceQuotient(curve, x0, x1, x2 + h)
+                                                              + secondDifferenceQuotient(curve, x0, x1, x2 - h));
+                    shaped[band] = (float)expected;
+                    weightedSum += shaped[band] * layout.weight[(size_t)band];
+                }
+
+                // The shaper's dynamic control, applied to the expected curve outputs
+                const float dynamicSmoothing = 1.0f / (1.0f + std::abs(weightedSum));
+
+                for (int band = 0; band < numBands; ++band)
+                {
+                    const float expected = shaped[band] * dynamicSmoothing * layout.makeup[(size_t)band];
+                    maxError = juce::jmax(maxError, std::abs(bands.getSample(band, n) - expected));
+                }
+            }
+
+            expect(maxError < 1.0e-5f, "error " + juce::String(maxError));
+        }
+    };
+
+    AdaaShaperTests adaaShaperTests;
+
+    //==============================================================================
+    /**
+        Checks PartitionedConvolution without its worker against direct convolution, for
+        responses just around the end of the direct head, the end of the audio thread's
+        partitions and the tail block edges, at block sizes that do and don't line up with
+        the partitions.
+    */
+    class PartitionedConvolutionTests : public juce::UnitTest
+    {
+    public:
+        PartitionedConvolutionTests() : juce::UnitTest("PartitionedConvolution", "DSP") {}
+
+        void runTest() override
+        {
+            constexpr int head = PartitionedConvolution::headSize;
+            constexpr int tail = PartitionedConvolution::tailSize;
+            constexpr int offset = PartitionedConvolution::tailOffset;
+
+            beginTest("Non-realtime output matches direct convolution");
+
+            for (int length : { head - 1, head, head + 1,
+                                offset - 1, offset, offset + 1,
+                                offset + tail - 1, offset + tail, offset + tail + 1,
+                                offset + 3 * tail - 1, offset + 3 * tail + 1 })
+            {
+                const auto impulseResponse = makeImpulseResponse(length);
+                const auto input = makeInput(length + 2 * tail);
+                const auto expected = convolveDirectly(impulseResponse, input);
+
+                for (int blockSize : { 1, 63, 64, 65, 1000, 4096 })
+                    check(impulseResponse, input, expected, blockSize);
+            }
+        }
+
+    private:
+        static constexpr int numChannels = 2;
+
+        /** Random taps under an exponential decay, normalised to unit energy like a cabinet response. */
+        juce::AudioBuffer<float> makeImpulseResponse(int length)
+        {
+            auto& random = getRandom();
+            juce::AudioBuffer<float> impulseResponse(numChannels, length);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                double energy = 0.0;
+
+                for (int i = 0; i < length; ++i)
+                {
+                    const float tap = (random.nextFloat() * 2.0f - 1.0f) * std::exp(-4.0f * (float)i / (float)length);
+                    impulseResponse.setSample(channel, i, tap);
+                    energy += (double)tap * tap;
+                }
+
+                for (int i = 0; i < length; ++i)
+                    impulseResponse.setSample(channel, i, impulseResponse.getSample(channel, i) / (float)std::sqrt(energy));
+            }
+
+            return impulseResponse;
+        }
+
+        juce::AudioBuffer<float> makeInput(int numSamples)
+        {
+            auto& random = getRandom();
+            juce::AudioBuffer<float> input(numChannels, numSamples);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    input.setSample(channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+            return input;
+        }
+
+        static std::vector<std::vector<double>> convolveDirectly(const juce::AudioBuffer<float>& impulseResponse,
+                                                                 const juce::AudioBuffer<float>& input)
+        {
+            const int length = impulseResponse.getNumSamples();
+            const int numSamples = input.getNumSamples();
+            std::vector<std::vector<double>> output((size_t)numChannels, std::vector<double>((size_t)numSamples));
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                const float* taps = impulseResponse.getReadPointer(channel);
+                const float* x = input.getReadPointer(channel);
+
+                for (int n = 0; n < numSamples; ++n)
+                {
+                    double sum = 0.0;
+
+                    for (int k = 0; k < juce::jmin(length, n + 1); ++k)
+                        sum += (double)taps[k] * x[n - k];
+
+                    output[(size_t)channel][(size_t)n] = sum;
+                }
+            }
+
+            return output;
+        }
+
+        void check(const juce::AudioBuffer<float>& impulseResponse, const juce::AudioBuffer<float>& input,
+                   const std::vector<std::vector<double>>& expected, int blockSize)
+        {
+            PartitionedConvolution convolution(impulseResponse, numChannels, false);
+            juce::AudioBuffer<float> output;
+            output.makeCopyOf(input);
+
+            const int numSamples = output.getNumSamples();
+            float* channels[numChannels];
+
+            for (int start = 0; start < numSamples; start += blockSize)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                    channels[channel] = output.getWritePointer(channel, start);
+
+                convolution.process(channels, juce::jmin(blockSize, numSamples - start));
+            }
+
+            double maxError = 0.0;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                    maxError = juce::jmax(maxError, std::abs(output.getSample(channel, i) - expected[(size_t)channel][(size_t)i]));
+
+            expect(maxError < 1.0e-5,
+                   juce::String(impulseResponse.getNumSamples()) + " taps, blocks of " + juce::String(blockSize)
+                       + ": error " + juce::String(maxError));
+        }
+    };
+
+    PartitionedConvolutionTests partitionedConvolutionTests;
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    const juce::ArgumentList arguments(argc, argv);
+    const auto seed = arguments.containsOption("--seed")
+                        ? arguments.getValueForOption("--seed").getLargeIntValue()
+                        : juce::Random::getSystemRandom().nextInt64();
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runAllTests(seed);
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        if (runner.getResult(i)->failures > 0)
+            return 1;
+
+    return 0;
+}